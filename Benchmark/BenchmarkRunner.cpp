@@ -0,0 +1,132 @@
+#include "BenchmarkRunner.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <QFile>
+#include "ThreadPool.h"
+#include "SimdKernels.h"
+
+namespace {
+	volatile double sink = 0;
+
+	QString getSimdLevelName(const SimdLevel level)
+	{
+		switch (level) {
+		case SimdLevel::SCALAR:
+			return "scalar";
+		case SimdLevel::SSE42:
+			return "sse4.2";
+		case SimdLevel::AVX2:
+			return "avx2";
+		}
+		return QString();
+	}
+}
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions &options)
+	: _options(options)
+{
+}
+
+std::vector<BenchmarkSize> BenchmarkRunner::getSizes() const
+{
+	const auto sizes = std::vector<BenchmarkSize>{
+		{ 256, 256, "256x256" },
+		{ 512, 512, "512x512" },
+		{ 1024, 1024, "1024x1024" },
+		{ 2048, 2048, "2048x2048" },
+		{ 4096, 4096, "4096x4096" },
+		{ 4320, 7680, "7680x4320" }
+	};
+	auto result = std::vector<BenchmarkSize>();
+	for (const auto &size : sizes) {
+		if (std::max(size.height, size.width) <= _options.maxSide) {
+			result.push_back(size);
+		}
+	}
+	return result;
+}
+
+QString BenchmarkRunner::getFullName(const QString &name, const QString &parameters, const BenchmarkSize &size)
+{
+	return parameters.isEmpty() ? name + "/" + size.name : name + "/" + parameters + "/" + size.name;
+}
+
+bool BenchmarkRunner::isEnabled(const QString &name, const QString &parameters, const BenchmarkSize &size) const
+{
+	return _options.filter.isEmpty() || getFullName(name, parameters, size).contains(_options.filter);
+}
+
+void BenchmarkRunner::run(const QString &name, const QString &parameters, const BenchmarkSize &size, const std::function<void()> &body)
+{
+	if (!isEnabled(name, parameters, size)) {
+		return;
+	}
+	typedef std::chrono::steady_clock Clock;
+	body();
+	auto times = std::vector<double>();
+	auto total = 0.;
+	while (int(times.size()) < _options.maxIterations
+		&& (int(times.size()) < _options.minIterations || total < _options.minTimeMs)) {
+		const auto start = Clock::now();
+		body();
+		const auto time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		times.push_back(time);
+		total += time;
+	}
+	std::sort(times.begin(), times.end());
+	const auto count = int(times.size());
+	const auto median = count % 2 == 1 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2;
+	const auto mean = total / count;
+	auto variance = 0.;
+	for (const auto time : times) {
+		variance += (time - mean) * (time - mean);
+	}
+	QJsonObject result;
+	result.insert("name", getFullName(name, parameters, size));
+	result.insert("benchmark", name);
+	result.insert("parameters", parameters);
+	result.insert("height", size.height);
+	result.insert("width", size.width);
+	result.insert("iterations", count);
+	result.insert("minMs", times.front());
+	result.insert("medianMs", median);
+	result.insert("meanMs", mean);
+	result.insert("maxMs", times.back());
+	result.insert("stddevMs", std::sqrt(variance / count));
+	result.insert("megapixelsPerSecond", double(size.height) * size.width / 1000. / median);
+	_results.append(result);
+	fprintf(stderr, "%-60s %10.3f ms (median of %d)\n", getFullName(name, parameters, size).toLocal8Bit().constData(), median, count);
+}
+
+QJsonDocument BenchmarkRunner::getReport() const
+{
+	QJsonObject report;
+	report.insert("label", _options.label);
+	report.insert("threads", ThreadPool::instance().getThreadsCount());
+	report.insert("simd", getSimdLevelName(SimdKernels::getLevel()));
+#ifdef NDEBUG
+	report.insert("build", "release");
+#else
+	report.insert("build", "debug");
+#endif
+	report.insert("minTimeMs", _options.minTimeMs);
+	report.insert("results", _results);
+	return QJsonDocument(report);
+}
+
+bool BenchmarkRunner::save() const
+{
+	const auto json = getReport().toJson();
+	if (_options.output.isEmpty()) {
+		return fwrite(json.constData(), 1, json.size(), stdout) == size_t(json.size());
+	}
+	QFile file(_options.output);
+	return file.open(QIODevice::WriteOnly) && file.write(json) == json.size();
+}
+
+void BenchmarkRunner::keep(const double value)
+{
+	sink = sink + value;
+}
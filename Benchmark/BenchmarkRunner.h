@@ -0,0 +1,58 @@
+#ifndef COMPUTERVISION_BENCHMARKRUNNER_H
+#define COMPUTERVISION_BENCHMARKRUNNER_H
+
+#include <vector>
+#include <functional>
+#include <QString>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+struct BenchmarkSize
+{
+	int height;
+	int width;
+	QString name;
+};
+
+struct BenchmarkOptions
+{
+	QString filter;
+	QString label;
+	QString output;
+	QString workFolder = "benchmark_work";
+	int maxSide = 7680;
+	double minTimeMs = 200;
+	int minIterations = 3;
+	int maxIterations = 1000;
+};
+
+// Times a body after one warm-up call until both minIterations and minTimeMs
+// are reached and keeps min/median/mean/max per benchmark.
+// A benchmark is named "<name>/<parameters>/<size>"; the filter is a substring
+// of that name, so "harris" or "/1024x1024" select a subset.
+class BenchmarkRunner
+{
+	BenchmarkOptions _options;
+	QJsonArray _results;
+
+public:
+	explicit BenchmarkRunner(const BenchmarkOptions &options);
+
+	const BenchmarkOptions &getOptions() const { return _options; }
+	// 256^2 up to 8K UHD, limited by maxSide.
+	std::vector<BenchmarkSize> getSizes() const;
+	static QString getFullName(const QString &name, const QString &parameters, const BenchmarkSize &size);
+	bool isEnabled(const QString &name, const QString &parameters, const BenchmarkSize &size) const;
+
+	void run(const QString &name, const QString &parameters, const BenchmarkSize &size, const std::function<void()> &body);
+
+	QJsonDocument getReport() const;
+	// Writes the report to the output file or to stdout when there is none.
+	bool save() const;
+
+	// Keeps a result alive so the measured call cannot be optimized away.
+	static void keep(const double value);
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "MicroBenchmarks.h"
+#include <vector>
+#include <QImage>
+#include "BenchmarkRunner.h"
+#include "SyntheticImages.h"
+#include "DescriptorSet.h"
+#include "DescriptorMatcher.h"
+#include "QuantizedDescriptorSet.h"
+#include "BinaryDescriptorSet.h"
+#include "IntegerImageHelper.h"
+#include "ConstantValues.h"
+
+namespace {
+	const auto MANY_POINTS_LIMIT = 2000;
+
+	Image getBoxKernel(const int size)
+	{
+		auto kernel = Image(size, size);
+		for (auto i = 0; i < size; ++i) {
+			for (auto j = 0; j < size; ++j) {
+				kernel.set(i, j, 1.f / (size * size));
+			}
+		}
+		return kernel;
+	}
+}
+
+void MicroBenchmarks::run(BenchmarkRunner &runner)
+{
+	for (const auto &size : runner.getSizes()) {
+		const auto image = SyntheticImages::create(size.height, size.width);
+
+		for (const auto kernelSize : { 3, 5, 9, 15 }) {
+			const auto kernel = getBoxKernel(kernelSize);
+			runner.run("conv", "kernel=" + QString::number(kernelSize), size, [&] {
+				BenchmarkRunner::keep(image.conv(kernel).getDataValue(0));
+			});
+		}
+		for (const auto sigma : { .5, 1., 1.6, 3.2, 6.4 }) {
+			runner.run("gauss", "sigma=" + QString::number(sigma), size, [&] {
+				BenchmarkRunner::keep(image.gauss(sigma).getDataValue(0));
+			});
+		}
+		runner.run("sobel", QString(), size, [&] {
+			BenchmarkRunner::keep(image.sobel().getDataValue(0));
+		});
+		runner.run("moravec", "shift=" + QString::number(MORAVEC_SHIFT), size, [&] {
+			BenchmarkRunner::keep(image.moravec(MORAVEC_SHIFT).getDataValue(0));
+		});
+		// 8-bit counterparts of the float operators; the pipeline does not use them yet.
+		const auto qImage = image.toQImage();
+		const auto byteImage = IntegerImageHelper::fromQImage(qImage);
+		runner.run("fromQImage", QString(), size, [&] {
+			BenchmarkRunner::keep(Image::fromQImage(qImage).getDataValue(0));
+		});
+		runner.run("fromQImageInteger", QString(), size, [&] {
+			BenchmarkRunner::keep(IntegerImageHelper::fromQImage(qImage).get(0, 0));
+		});
+		runner.run("sobelX", QString(), size, [&] {
+			BenchmarkRunner::keep(image.sobelX().getDataValue(0));
+		});
+		runner.run("sobelXInteger", QString(), size, [&] {
+			BenchmarkRunner::keep(IntegerImageHelper::sobelX(byteImage).get(0, 0));
+		});
+		runner.run("moravecInteger", "shift=" + QString::number(MORAVEC_SHIFT), size, [&] {
+			BenchmarkRunner::keep(IntegerImageHelper::moravec(byteImage, MORAVEC_SHIFT).get(0, 0));
+		});
+		runner.run("harris", "mode=fused", size, [&] {
+			BenchmarkRunner::keep(image.harris(HARRIS_SIGMA, BorderEffectType::COPY, HarrisMode::FUSED).getDataValue(0));
+		});
+		runner.run("harris", "mode=basic", size, [&] {
+			BenchmarkRunner::keep(image.harris(HARRIS_SIGMA, BorderEffectType::COPY, HarrisMode::BASIC).getDataValue(0));
+		});
+
+		// Inputs of the later stages are built on first use only, so a filter
+		// on an early stage does not pay for them.
+		auto harris = Image();
+		const auto getHarris = [&]() -> const Image & {
+			if (harris.getHeight() == 0) {
+				harris = image.harris(HARRIS_SIGMA);
+			}
+			return harris;
+		};
+		auto maximums = std::vector<ImagePoint>();
+		auto hasMaximums = false;
+		const auto getMaximums = [&]() -> const std::vector<ImagePoint> & {
+			if (!hasMaximums) {
+				maximums = getHarris().getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
+				hasMaximums = true;
+			}
+			return maximums;
+		};
+
+		const auto localMaximumsParameters = "shift=" + QString::number(LOCAL_MAXIMUMS_SHIFT);
+		if (runner.isEnabled("getLocalMaximums", localMaximumsParameters, size)) {
+			getHarris();
+			runner.run("getLocalMaximums", localMaximumsParameters, size, [&] {
+				BenchmarkRunner::keep(double(harris.getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD).size()));
+			});
+		}
+		for (const auto limit : { POINTS_LIMIT, MANY_POINTS_LIMIT }) {
+			const auto parameters = "points=" + QString::number(limit);
+			if (runner.isEnabled("nonMaxSuppression", parameters, size)) {
+				getMaximums();
+				runner.run("nonMaxSuppression", parameters, size, [&] {
+					BenchmarkRunner::keep(double(image.nonMaxSuppression(maximums, limit, NONMAX_FILTER_VALUE).size()));
+				});
+			}
+			const auto describe = runner.isEnabled("getDescriptors", parameters, size);
+			const auto describeRotateInvariant = runner.isEnabled("getDescriptorsRotateInvariant", parameters, size);
+			const auto match = runner.isEnabled("match", parameters, size)
+				|| runner.isEnabled("matchQuantized", parameters, size)
+				|| runner.isEnabled("matchBinary", parameters, size)
+				|| runner.isEnabled("matchRerankedBinary", parameters, size);
+			if (!describe && !describeRotateInvariant && !match) {
+				continue;
+			}
+			const auto points = image.nonMaxSuppression(getMaximums(), limit, NONMAX_FILTER_VALUE);
+			runner.run("getDescriptors", parameters, size, [&] {
+				BenchmarkRunner::keep(image.getDescriptors(points, GAUSS_KERNEL_RADIUS).getCount());
+			});
+			runner.run("getDescriptorsRotateInvariant", parameters, size, [&] {
+				BenchmarkRunner::keep(image.getDescriptorsRotateInvariant(points, GAUSS_KERNEL_RADIUS).getCount());
+			});
+			if (match) {
+				const auto shifted = SyntheticImages::create(size.height, size.width, 0, 7, 11);
+				const auto shiftedPoints = shifted.nonMaxSuppression(
+					shifted.harris(HARRIS_SIGMA).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD), limit, NONMAX_FILTER_VALUE);
+				const auto descriptors = image.getDescriptors(points, GAUSS_KERNEL_RADIUS);
+				const auto shiftedDescriptors = shifted.getDescriptors(shiftedPoints, GAUSS_KERNEL_RADIUS);
+				runner.run("match", parameters, size, [&] {
+					BenchmarkRunner::keep(double(DescriptorMatcher::match(descriptors, shiftedDescriptors).size()));
+				});
+				const auto quantized = QuantizedDescriptorSet(descriptors);
+				const auto shiftedQuantized = QuantizedDescriptorSet(shiftedDescriptors);
+				runner.run("matchQuantized", parameters, size, [&] {
+					BenchmarkRunner::keep(double(DescriptorMatcher::match(quantized, shiftedQuantized).size()));
+				});
+				const auto binary = BinaryDescriptorSet(descriptors);
+				const auto shiftedBinary = BinaryDescriptorSet(shiftedDescriptors);
+				runner.run("matchBinary", parameters, size, [&] {
+					BenchmarkRunner::keep(double(DescriptorMatcher::match(binary, shiftedBinary).size()));
+				});
+				runner.run("matchRerankedBinary", parameters, size, [&] {
+					BenchmarkRunner::keep(double(DescriptorMatcher::matchReranked(binary, shiftedBinary, descriptors, shiftedDescriptors).size()));
+				});
+			}
+		}
+	}
+}
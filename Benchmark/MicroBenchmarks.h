@@ -0,0 +1,15 @@
+#ifndef COMPUTERVISION_MICROBENCHMARKS_H
+#define COMPUTERVISION_MICROBENCHMARKS_H
+
+class BenchmarkRunner;
+
+// Single operations of the pipeline on synthetic images of every size.
+class MicroBenchmarks
+{
+	MicroBenchmarks() = delete;
+
+public:
+	static void run(BenchmarkRunner &runner);
+};
+
+#endif
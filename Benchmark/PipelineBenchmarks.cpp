@@ -0,0 +1,50 @@
+#include "PipelineBenchmarks.h"
+#include <vector>
+#include <QDir>
+#include "BenchmarkRunner.h"
+#include "SyntheticImages.h"
+#include "Tasks.h"
+
+namespace {
+	struct PipelineTask
+	{
+		QString name;
+		TaskType type;
+		QString result;
+	};
+}
+
+void PipelineBenchmarks::run(BenchmarkRunner &runner)
+{
+	const auto tasks = std::vector<PipelineTask>{
+		{ "sobel", TaskType::SOBEL, "sobel.jpg" },
+		{ "pyramid", TaskType::PYRAMID, "pyramid" },
+		{ "interesting", TaskType::INTERESTING_POINTS, "interesting" },
+		{ "descriptors", TaskType::DESCRIPTORS_BASIC, "descriptors.jpg" },
+		{ "descriptors-rotate", TaskType::DESCRIPTORS_ROTATE_INVARIANT, "descriptors_rotate.jpg" }
+	};
+	for (const auto &size : runner.getSizes()) {
+		auto enabled = false;
+		for (const auto &task : tasks) {
+			enabled = enabled || runner.isEnabled("task", task.name, size);
+		}
+		if (!enabled) {
+			continue;
+		}
+		const auto folder = runner.getOptions().workFolder + "/" + size.name;
+		QDir().mkpath(folder);
+		const auto source = folder + "/image.png";
+		const auto sourceModified = folder + "/image_modified.png";
+		SyntheticImages::create(size.height, size.width).toQImage().save(source);
+		SyntheticImages::create(size.height, size.width, 0, 7, 11).toQImage().save(sourceModified);
+		for (const auto &task : tasks) {
+			const auto resultPath = folder + "/" + task.result;
+			if (Tasks::hasResultFolder(task.type)) {
+				QDir().mkpath(resultPath);
+			}
+			runner.run("task", task.name, size, [&] {
+				BenchmarkRunner::keep(Tasks::save(Tasks::run(task.type, source, sourceModified, resultPath)));
+			});
+		}
+	}
+}
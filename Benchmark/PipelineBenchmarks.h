@@ -0,0 +1,16 @@
+#ifndef COMPUTERVISION_PIPELINEBENCHMARKS_H
+#define COMPUTERVISION_PIPELINEBENCHMARKS_H
+
+class BenchmarkRunner;
+
+// The five tasks of main() end to end, decoding and encoding included.
+// Inputs are synthetic PNGs written to the work folder once per size.
+class PipelineBenchmarks
+{
+	PipelineBenchmarks() = delete;
+
+public:
+	static void run(BenchmarkRunner &runner);
+};
+
+#endif
@@ -0,0 +1,25 @@
+#include "SyntheticImages.h"
+#include <cmath>
+#include <cstdint>
+#include "ThreadPool.h"
+
+Image SyntheticImages::create(const int height, const int width, const int seed, const int shiftY, const int shiftX)
+{
+	auto image = Image::createUninitialized(height, width);
+	ThreadPool::instance().parallelFor(0, height, [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			for (auto j = 0; j < width; ++j) {
+				const auto y = i + shiftY;
+				const auto x = j + shiftX;
+				auto hash = uint32_t(i) * 73856093u ^ uint32_t(j) * 19349663u ^ uint32_t(seed + 1) * 83492791u;
+				hash = (hash ^ (hash >> 13)) * 1274126177u;
+				const auto noise = float(hash >> 24) / 255 - .5f;
+				const auto shading = .5f + .2f * std::sin(y * .013f + seed) * std::cos(x * .011f);
+				const auto block = ((y >> 4) + (x >> 4) + seed) % 2 == 0 ? .2f : -.2f;
+				const auto visible = ((y >> 6) * 5 + (x >> 6) * 3) % 3 == 0;
+				image.set(i, j, shading + (visible ? block : 0) + .02f * noise);
+			}
+		}
+	});
+	return image;
+}
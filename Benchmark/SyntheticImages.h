@@ -0,0 +1,18 @@
+#ifndef COMPUTERVISION_SYNTHETICIMAGES_H
+#define COMPUTERVISION_SYNTHETICIMAGES_H
+
+#include "Image.h"
+
+// Deterministic test images: smooth shading, a sparse checkerboard that gives
+// Harris and Moravec corners at every scale, and a little noise.
+// The pattern is a function of the absolute position, so shifted copies of one
+// seed share their features and can be matched.
+class SyntheticImages
+{
+	SyntheticImages() = delete;
+
+public:
+	static Image create(const int height, const int width, const int seed = 0, const int shiftY = 0, const int shiftX = 0);
+};
+
+#endif
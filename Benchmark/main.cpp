@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "BenchmarkRunner.h"
+#include "MicroBenchmarks.h"
+#include "PipelineBenchmarks.h"
+#include "ThreadPool.h"
+#include "SimdKernels.h"
+#include "Trace.h"
+
+namespace {
+	void printUsage(const char *name)
+	{
+		fprintf(stderr,
+			"usage: %s [options]\n"
+			"  --filter <text>     run benchmarks whose name contains text\n"
+			"  --max-side <n>      skip images with a side above n (default 7680)\n"
+			"  --min-time <ms>     minimal measured time per benchmark (default 200)\n"
+			"  --min-iterations <n>\n"
+			"  --threads <n>       thread pool size\n"
+			"  --simd scalar|sse4.2|avx2\n"
+			"  --no-micro          skip single operations\n"
+			"  --no-pipeline       skip the end-to-end tasks\n"
+			"  --work <folder>     inputs and outputs of the end-to-end tasks\n"
+			"  --label <text>      build label stored in the report\n"
+			"  --output <file>     JSON report, stdout by default\n"
+			"  --trace <file>      Chrome trace of the stages (builds with CVISION_TRACE)\n",
+			name);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	auto options = BenchmarkOptions();
+	auto micro = true;
+	auto pipeline = true;
+	auto traceFile = QString();
+	for (auto i = 1; i < argc; ++i) {
+		const auto hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--no-micro") == 0) {
+			micro = false;
+		} else if (strcmp(argv[i], "--no-pipeline") == 0) {
+			pipeline = false;
+		} else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+			options.filter = argv[++i];
+		} else if (strcmp(argv[i], "--max-side") == 0 && hasValue) {
+			options.maxSide = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+			options.minTimeMs = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--min-iterations") == 0 && hasValue) {
+			options.minIterations = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+			ThreadPool::setThreadsCount(atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--simd") == 0 && hasValue) {
+			const auto level = QString(argv[++i]);
+			SimdKernels::setLevel(level == "scalar" ? SimdLevel::SCALAR : level == "sse4.2" ? SimdLevel::SSE42 : SimdLevel::AVX2);
+		} else if (strcmp(argv[i], "--work") == 0 && hasValue) {
+			options.workFolder = argv[++i];
+		} else if (strcmp(argv[i], "--label") == 0 && hasValue) {
+			options.label = argv[++i];
+		} else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+			options.output = argv[++i];
+		} else if (strcmp(argv[i], "--trace") == 0 && hasValue) {
+			traceFile = argv[++i];
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+	auto runner = BenchmarkRunner(options);
+	if (micro) {
+		MicroBenchmarks::run(runner);
+	}
+	if (pipeline) {
+		PipelineBenchmarks::run(runner);
+	}
+#ifdef CVISION_TRACE
+	if (!traceFile.isEmpty()) {
+		Tracer::saveChromeTrace(traceFile);
+		fputs(Tracer::getSummary().toLocal8Bit().constData(), stderr);
+	}
+#endif
+	return runner.save() ? 0 : 2;
+}
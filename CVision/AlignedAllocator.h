@@ -0,0 +1,64 @@
+#ifndef COMPUTERVISION_ALIGNEDALLOCATOR_H
+#define COMPUTERVISION_ALIGNEDALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "ConstantValues.h"
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+template<typename T, size_t Alignment = SIMD_ALIGNMENT>
+class AlignedAllocator
+{
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind {
+		typedef AlignedAllocator<U, Alignment> other;
+	};
+
+	AlignedAllocator() noexcept {}
+
+	template<typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+	T *allocate(const size_t count)
+	{
+		if (count == 0) {
+			return nullptr;
+		}
+		const auto bytes = count * sizeof(T);
+#ifdef _MSC_VER
+		auto pointer = _aligned_malloc(bytes, Alignment);
+#else
+		void *pointer = nullptr;
+		if (posix_memalign(&pointer, Alignment, bytes) != 0) {
+			pointer = nullptr;
+		}
+#endif
+		if (pointer == nullptr) {
+			throw std::bad_alloc();
+		}
+		return static_cast<T *>(pointer);
+	}
+
+	void deallocate(T *pointer, const size_t) noexcept
+	{
+#ifdef _MSC_VER
+		_aligned_free(pointer);
+#else
+		free(pointer);
+#endif
+	}
+};
+
+template<typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) { return true; }
+
+template<typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &) { return false; }
+
+#endif
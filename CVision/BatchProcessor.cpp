@@ -0,0 +1,122 @@
+#include "BatchProcessor.h"
+#include <algorithm>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QCollator>
+#include "BoundedQueue.h"
+#include "ThreadPool.h"
+
+std::vector<BatchItem> BatchProcessor::readManifest(const QString &fileName)
+{
+	auto result = std::vector<BatchItem>();
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return result;
+	}
+	const auto directory = QFileInfo(fileName).dir();
+	QTextStream stream(&file);
+	while (!stream.atEnd()) {
+		const auto line = stream.readLine().simplified();
+		if (line.isEmpty() || line.startsWith('#')) {
+			continue;
+		}
+		const auto parts = line.split(' ');
+		auto item = BatchItem();
+		item.source = directory.filePath(parts[0]);
+		if (parts.size() > 1) {
+			item.sourceModified = directory.filePath(parts[1]);
+		}
+		result.push_back(item);
+	}
+	return result;
+}
+
+std::vector<BatchItem> BatchProcessor::listFolder(const QString &folder, const TaskType type)
+{
+	const auto directory = QDir(folder);
+	auto names = directory.entryList(QStringList{ "*.jpg", "*.jpeg", "*.png", "*.bmp", "*.tif", "*.tiff" }, QDir::Files, QDir::NoSort);
+	QCollator collator;
+	collator.setNumericMode(true);
+	std::sort(names.begin(), names.end(), [&](const QString &a, const QString &b) {
+		return collator.compare(a, b) < 0;
+	});
+	auto result = std::vector<BatchItem>();
+	const auto pairs = Tasks::isPairTask(type);
+	for (auto i = 0; i + (pairs ? 1 : 0) < int(names.size()); ++i) {
+		auto item = BatchItem();
+		item.source = directory.filePath(names[i]);
+		if (pairs) {
+			item.sourceModified = directory.filePath(names[i + 1]);
+		}
+		result.push_back(item);
+	}
+	return result;
+}
+
+QString BatchProcessor::getResultPath(const TaskType type, const BatchItem &item, const QString &resultFolder)
+{
+	const auto name = QFileInfo(item.source).completeBaseName();
+	if (Tasks::hasResultFolder(type)) {
+		return resultFolder + "/" + name;
+	}
+	if (Tasks::isPairTask(type)) {
+		return resultFolder + "/" + name + "___" + QFileInfo(item.sourceModified).completeBaseName() + ".jpg";
+	}
+	return resultFolder + "/" + name + ".jpg";
+}
+
+int BatchProcessor::run(const TaskType type,
+	const std::vector<BatchItem> &items,
+	const QString &resultFolder,
+	const std::function<void(const BatchProgress &)> &progress,
+	const int queueCapacity)
+{
+	struct Result
+	{
+		int index;
+		std::vector<TaskOutput> outputs;
+	};
+
+	const auto total = int(items.size());
+	auto state = BatchProgress{ 0, 0, total, QString(), false };
+	const auto write = [&](const Result &result) {
+		for (const auto &output : result.outputs) {
+			QDir().mkpath(QFileInfo(output.path).path());
+		}
+		state.source = items[result.index].source;
+		state.succeeded = Tasks::save(result.outputs);
+		++state.done;
+		state.failed += state.succeeded ? 0 : 1;
+		if (progress) {
+			progress(state);
+		}
+	};
+	const auto process = [&](const int index) {
+		const auto &item = items[index];
+		if (Tasks::isPairTask(type) && item.sourceModified.isEmpty()) {
+			return Result{ index, {} };
+		}
+		return Result{ index, Tasks::run(type, item.source, item.sourceModified, getResultPath(type, item, resultFolder)) };
+	};
+
+	auto &pool = ThreadPool::instance();
+	if (pool.getThreadsCount() == 1) {
+		for (auto i = 0; i < total; ++i) {
+			write(process(i));
+		}
+		return state.failed;
+	}
+	BoundedQueue<Result> results(queueCapacity);
+	for (auto i = 0; i < total; ++i) {
+		pool.submit([&, i] {
+			results.push(process(i));
+		});
+	}
+	auto result = Result();
+	while (state.done < total && results.pop(result)) {
+		write(result);
+	}
+	return state.failed;
+}
@@ -0,0 +1,50 @@
+#ifndef COMPUTERVISION_BATCHPROCESSOR_H
+#define COMPUTERVISION_BATCHPROCESSOR_H
+
+#include <vector>
+#include <functional>
+#include <QString>
+#include "Tasks.h"
+#include "ConstantValues.h"
+
+struct BatchItem
+{
+	QString source;
+	QString sourceModified;
+};
+
+struct BatchProgress
+{
+	int done;
+	int failed;
+	int total;
+	QString source;
+	bool succeeded;
+};
+
+// Runs one task over many images. Every item is a task on the shared
+// work-stealing ThreadPool, so the parallel loops inside an item keep idle
+// threads busy when there are fewer items left than threads.
+// Results go through a bounded queue to the calling thread, which creates the
+// folders, writes the files and reports progress once per item.
+class BatchProcessor
+{
+	BatchProcessor() = delete;
+
+public:
+	// One item per line: "source [modified]", '#' starts a comment.
+	// Relative paths are taken relative to the manifest folder.
+	static std::vector<BatchItem> readManifest(const QString &fileName);
+	// Images of the folder in natural order; pair tasks match every image with the next one.
+	static std::vector<BatchItem> listFolder(const QString &folder, const TaskType type);
+	static QString getResultPath(const TaskType type, const BatchItem &item, const QString &resultFolder);
+
+	// Returns the number of failed items.
+	static int run(const TaskType type,
+		const std::vector<BatchItem> &items,
+		const QString &resultFolder,
+		const std::function<void(const BatchProgress &)> &progress,
+		const int queueCapacity = BATCH_OUTPUT_QUEUE_CAPACITY);
+};
+
+#endif
@@ -0,0 +1,33 @@
+#include "BinaryDescriptorSet.h"
+#include "DescriptorSet.h"
+#include "SimdKernels.h"
+
+BinaryDescriptorSet::BinaryDescriptorSet(const DescriptorSet &descriptors)
+	: _dimension(descriptors.getDimension()),
+	_words((_dimension + 63) / 64),
+	_data(size_t(descriptors.getCount()) * _words, 0)
+{
+	for (auto k = 0; k < descriptors.getCount(); ++k) {
+		const auto source = descriptors.getRow(k);
+		auto mean = 0.;
+		for (auto i = 0; i < _dimension; ++i) {
+			mean += source[i];
+		}
+		mean /= _dimension;
+		auto row = _data.data() + size_t(k) * _words;
+		for (auto i = 0; i < _dimension; ++i) {
+			if (source[i] > mean) {
+				row[i / 64] |= uint64_t(1) << (i % 64);
+			}
+		}
+	}
+}
+
+void BinaryDescriptorSet::getRawDistances(const int index, const BinaryDescriptorSet &train, const int begin, const int end, int *result) const
+{
+	Q_ASSERT(sameLayout(train));
+	if (begin >= end) {
+		return;
+	}
+	SimdKernels::hammingDistances(result, getRow(index), train.getRow(begin), _words, end - begin);
+}
@@ -0,0 +1,39 @@
+#ifndef COMPUTERVISION_BINARYDESCRIPTORSET_H
+#define COMPUTERVISION_BINARYDESCRIPTORSET_H
+
+#include <vector>
+#include <cstdint>
+#include <qglobal.h>
+
+class DescriptorSet;
+
+// One bit per value of the rows of a DescriptorSet, set where the value is
+// above the mean of its row: 16 bytes for the default 128 dimensions, a
+// thirty-second of the float rows. Distances are Hamming distances in bits.
+// Row i belongs to keypoint i of the source set.
+class BinaryDescriptorSet
+{
+	int _dimension;
+	int _words;
+	std::vector<uint64_t> _data;
+
+public:
+	explicit BinaryDescriptorSet(const DescriptorSet &descriptors);
+
+	int getCount() const { return _words == 0 ? 0 : int(_data.size() / _words); }
+	int getDimension() const { return _dimension; }
+	int getWords() const { return _words; }
+
+	const uint64_t *getRow(const int index) const {
+		Q_ASSERT(index >= 0 && index < getCount());
+		return _data.data() + size_t(index) * _words;
+	}
+
+	// Hamming distances from row index to train rows [begin, end), the raw
+	// distances the matcher ranks by.
+	void getRawDistances(const int index, const BinaryDescriptorSet &train, const int begin, const int end, int *result) const;
+	static double toDistance(const int rawDistance) { return rawDistance; }
+	bool sameLayout(const BinaryDescriptorSet &other) const { return _words == other._words; }
+};
+
+#endif
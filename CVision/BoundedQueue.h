@@ -0,0 +1,65 @@
+#ifndef COMPUTERVISION_BOUNDEDQUEUE_H
+#define COMPUTERVISION_BOUNDEDQUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// Blocking FIFO between pipeline stages: push waits while the queue is full,
+// pop waits while it is empty and returns false once it is closed and drained.
+template<typename T>
+class BoundedQueue
+{
+	std::deque<T> _items;
+	int _capacity;
+	bool _closed = false;
+	std::mutex _mutex;
+	std::condition_variable _notFull;
+	std::condition_variable _notEmpty;
+
+public:
+	explicit BoundedQueue(const int capacity) : _capacity(capacity) {}
+	BoundedQueue(const BoundedQueue &) = delete;
+	BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+	void push(T item);
+	bool pop(T &item);
+	void close();
+};
+
+template<typename T>
+void BoundedQueue<T>::push(T item)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_notFull.wait(lock, [this] { return _closed || int(_items.size()) < _capacity; });
+	if (_closed) {
+		return;
+	}
+	_items.push_back(std::move(item));
+	_notEmpty.notify_one();
+}
+
+template<typename T>
+bool BoundedQueue<T>::pop(T &item)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_notEmpty.wait(lock, [this] { return _closed || !_items.empty(); });
+	if (_items.empty()) {
+		return false;
+	}
+	item = std::move(_items.front());
+	_items.pop_front();
+	_notFull.notify_one();
+	return true;
+}
+
+template<typename T>
+void BoundedQueue<T>::close()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_closed = true;
+	_notFull.notify_all();
+	_notEmpty.notify_all();
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "BufferPool.h"
+#include "AlignedAllocator.h"
+
+void BufferPool::Deleter::operator()(float *data) const
+{
+	if (data != nullptr) {
+		BufferPool::instance().release(data, _capacity);
+	}
+}
+
+BufferPool::BufferPool(const size_t maxCachedBytes) : _maxCachedBytes(maxCachedBytes)
+{
+}
+
+BufferPool::~BufferPool()
+{
+	trim();
+}
+
+BufferPool &BufferPool::instance()
+{
+	static auto pool = new BufferPool();
+	return *pool;
+}
+
+size_t BufferPool::getCapacity(const size_t size)
+{
+	if (size <= MIN_CAPACITY) {
+		return MIN_CAPACITY;
+	}
+	auto octave = MIN_CAPACITY;
+	while (octave * 2 < size) {
+		octave *= 2;
+	}
+	const auto step = octave / CLASSES_PER_OCTAVE;
+	return octave + (size - octave + step - 1) / step * step;
+}
+
+BufferPool::Buffer BufferPool::allocate(const size_t size)
+{
+	if (size == 0) {
+		return Buffer();
+	}
+	const auto capacity = getCapacity(size);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto &buffers = _free[capacity];
+		if (!buffers.empty()) {
+			const auto data = buffers.back();
+			buffers.pop_back();
+			_cachedBytes -= capacity * sizeof(float);
+			return Buffer(data, Deleter(capacity));
+		}
+	}
+	return Buffer(AlignedAllocator<float>().allocate(capacity), Deleter(capacity));
+}
+
+std::shared_ptr<float> BufferPool::allocateShared(const size_t size)
+{
+	auto buffer = allocate(size);
+	const auto deleter = buffer.get_deleter();
+	return std::shared_ptr<float>(buffer.release(), deleter);
+}
+
+void BufferPool::release(float *data, const size_t capacity)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_cachedBytes + capacity * sizeof(float) <= _maxCachedBytes) {
+			_free[capacity].push_back(data);
+			_cachedBytes += capacity * sizeof(float);
+			return;
+		}
+	}
+	AlignedAllocator<float>().deallocate(data, capacity);
+}
+
+size_t BufferPool::getCachedBytes()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _cachedBytes;
+}
+
+void BufferPool::trim()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto &buffers : _free) {
+		for (auto data : buffers.second) {
+			AlignedAllocator<float>().deallocate(data, buffers.first);
+		}
+	}
+	_free.clear();
+	_cachedBytes = 0;
+}
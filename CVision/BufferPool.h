@@ -0,0 +1,55 @@
+#ifndef COMPUTERVISION_BUFFERPOOL_H
+#define COMPUTERVISION_BUFFERPOOL_H
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include "ConstantValues.h"
+
+// Recycles float buffers by size class, so the large temporaries of every
+// pipeline stage reuse memory that is already mapped instead of faulting in
+// fresh pages. There are four classes per power of two (at most 25% slack).
+// Buffers are SIMD_ALIGNMENT aligned and uninitialized. Released buffers are
+// cached up to maxCachedBytes; beyond that they go back to the system.
+class BufferPool
+{
+	static const int CLASSES_PER_OCTAVE = 4;
+	static const size_t MIN_CAPACITY = 64;
+
+	std::mutex _mutex;
+	std::map<size_t, std::vector<float *>> _free;
+	size_t _cachedBytes = 0;
+	size_t _maxCachedBytes;
+
+	void release(float *data, const size_t capacity);
+
+public:
+	class Deleter {
+		size_t _capacity = 0;
+
+	public:
+		Deleter() {}
+		explicit Deleter(const size_t capacity) : _capacity(capacity) {}
+		size_t getCapacity() const { return _capacity; }
+		void operator()(float *data) const;
+	};
+
+	typedef std::unique_ptr<float[], Deleter> Buffer;
+
+	explicit BufferPool(const size_t maxCachedBytes = BUFFER_POOL_MAX_CACHED_BYTES);
+	~BufferPool();
+	BufferPool(const BufferPool &) = delete;
+	BufferPool &operator=(const BufferPool &) = delete;
+
+	// Never destroyed, so buffers owned by static objects can be released at exit.
+	static BufferPool &instance();
+	static size_t getCapacity(const size_t size);
+
+	Buffer allocate(const size_t size);
+	std::shared_ptr<float> allocateShared(const size_t size);
+	size_t getCachedBytes();
+	void trim();
+};
+
+#endif
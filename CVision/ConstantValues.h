@@ -12,6 +12,7 @@ const QString RESULT_PYRAMID_FOLDER = "result_pyramid";
 const QString RESULT_INTERESTING_FOLDER = "result_interesting";
 const QString RESULT_DESCRIPTORS_BASIC = "result_descriptors_basic/descriptors.jpg";
 const QString RESULT_DESCRIPTORS_ROTATE_INVARIANT = "result_descriptors_rotate_invariant/descriptors.jpg";
+const QString TRACE_FILE = "trace.json";
 
 
 //#2
@@ -22,7 +23,12 @@ const auto SIGMA = 1.6;
 //#3
 const auto POINTS_LIMIT = 200;
 const auto MORAVEC_SHIFT = 2;
+const auto MORAVEC_TILE_HEIGHT = 64;
 const auto HARRIS_SIGMA = 1;
+const auto HARRIS_TILE_HEIGHT = 64;
+const auto TILE_SIZE = 1024;
+const auto FRAME_QUEUE_CAPACITY = 2;
+const auto BATCH_OUTPUT_QUEUE_CAPACITY = 16;
 const auto LOCAL_MAXIMUMS_SHIFT = 2;
 const auto LOCAL_MAXIMUMS_TRESHOLD = .01;
 const auto NONMAX_FILTER_VALUE = .9;
@@ -30,10 +36,18 @@ const auto NONMAX_FILTER_VALUE = .9;
 //#4 #5
 const auto BIN_EPSILON = 1e-9;
 const auto GAUSS_KERNEL_RADIUS = 8;
+const auto GRADIENT_FIELD_HALO = 2 * GAUSS_KERNEL_RADIUS;
 const auto BIN_ROTATION_IVARIANT_ORIENTATIONS_COUNT = 36;
 const auto SECOND_MAIN_ORIENTATION_TRESHOLD = .8;
 const auto MINDISTANCE_TRESHOLD = .3;
 const auto DEFAULT_DESCRIPTOR_SIZE = 4;
 const auto DEFAULT_DESCRIPTOR_ORIENTATIONS_COUNT = 8;
+const auto DEFAULT_DESCRIPTOR_DIMENSION = DEFAULT_DESCRIPTOR_SIZE * DEFAULT_DESCRIPTOR_SIZE * DEFAULT_DESCRIPTOR_ORIENTATIONS_COUNT;
+const auto DESCRIPTOR_ROW_ALIGNMENT = 8;
+const auto QUANTIZED_DESCRIPTOR_ROW_ALIGNMENT = 32;
+const auto DESCRIPTOR_QUANTIZATION_SCALE = 512.f;
+const auto DESCRIPTOR_RERANK_CANDIDATES = 8;
+const auto SIMD_ALIGNMENT = 32;
+const auto BUFFER_POOL_MAX_CACHED_BYTES = size_t(256) << 20;
 
 #endif
\ No newline at end of file
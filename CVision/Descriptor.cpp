@@ -14,16 +14,6 @@ Descriptor::Descriptor(const int x, const int y, const double angle, const int s
 	std::for_each(begin(), end(), [&](double &val) { val = 0; });
 }
 
-double Descriptor::distanceToDescriptor(const Descriptor& descriptor) const
-{
-	Q_ASSERT(_size == descriptor._size && _orientationsCount == descriptor._orientationsCount);
-	auto length = 0.;
-	for (auto i = 0; i < _dataSize; ++i) {
-		length += (_data[i] - descriptor._data[i]) * (_data[i] - descriptor._data[i]);
-	}
-	return sqrt(length);
-}
-
 void Descriptor::normalize() {
 	auto length = 0.;
 	for (auto i = 0; i < _dataSize; ++i) {
@@ -2,6 +2,7 @@
 #define COMPUTERVISION_DESCRIPTOR_H
 
 #include <memory>
+#include <vector>
 #include "ConstantValues.h"
 
 class Descriptor {
@@ -53,7 +54,6 @@ public:
 
 	void addValueOnAngleWithIndex(const int i, const int j, const double angle, const double value) const;
 	void addValueOnAngle(const double angle, const double value) const;
-	double distanceToDescriptor(const Descriptor &descriptor) const;
 	void normalize();
 	std::vector<double> maxOrientationInterpolatedAngles() const;
 };
@@ -1,24 +1,102 @@
 #include "DescriptorHelper.h"
+#include "DescriptorSet.h"
 #include "Descriptor.h"
+#include "GradientField.h"
+#include "ImageHelper.h"
+#include "KernelsFactory.h"
+#include "ConstantValues.h"
+#include "Trace.h"
 #include <QPainter>
+#include <qmath.h>
 
-void DescriptorHelper::drawDescriptors(QPainter &painter, const std::vector<Descriptor> &descriptors, const std::vector<Descriptor> &descriptorsOfModified, const int &imageWidth, const double &minDistanceTreshold) {
-	for (auto i = 0; i < descriptors.size(); ++i) {
-		auto minDist = std::numeric_limits<double>::max();
-		auto answer = 0;
-		for (auto j = 0; j < descriptorsOfModified.size(); ++j) {
-			if (minDist > descriptors[i].distanceToDescriptor(descriptorsOfModified[j])) {
-				minDist = descriptors[i].distanceToDescriptor(descriptorsOfModified[j]);
-				answer = j;
+DescriptorSet DescriptorHelper::getDescriptors(const GradientField &gradient, const std::vector<ImagePoint> &points, const int gaussKernelRadius) {
+	TRACE_SCOPE_IMAGE("DescriptorHelper::getDescriptors", gradient.getHeight(), gradient.getWidth());
+	TRACE_SET_POINTS(points.size());
+	const auto &kernel = KernelsFactory::gaussKernel(gaussKernelRadius, GaussKernelType::FULL);
+	auto descriptors = DescriptorSet();
+	descriptors.reserve(int(points.size()));
+	const auto netStep = int(ceil(kernel.getWidth() / double(descriptors.getSize())));
+	auto magnitudesBuffer = std::vector<float>();
+	auto anglesBuffer = std::vector<float>();
+	for (auto point : points) {
+		const auto index = descriptors.add(point.getX(), point.getY());
+		for (auto i = point.getX() - gaussKernelRadius, kernel_i = 0; i < point.getX() + gaussKernelRadius; ++i, ++kernel_i) {
+			const auto magnitudes = gradient.getMagnitudeWindowRow(i, point.getY(), gaussKernelRadius, magnitudesBuffer);
+			const auto angles = gradient.getAngleWindowRow(i, point.getY(), gaussKernelRadius, anglesBuffer);
+			for (auto kernel_j = 0; kernel_j < 2 * gaussKernelRadius; ++kernel_j) {
+				const auto gradLength = magnitudes[kernel_j] * kernel.get(kernel_i, kernel_j);
+				descriptors.addValueOnAngleWithIndex(index, kernel_i / netStep, kernel_j / netStep, angles[kernel_j], gradLength);
 			}
 		}
-		if (minDist > minDistanceTreshold) {
-			continue;
+		descriptors.normalize(index);
+	}
+	return descriptors;
+}
+
+DescriptorSet DescriptorHelper::getDescriptorsRotateInvariant(const GradientField &gradient, const std::vector<ImagePoint> &points, const int gaussKernelRadius) {
+	TRACE_SCOPE_IMAGE("DescriptorHelper::getDescriptorsRotateInvariant", gradient.getHeight(), gradient.getWidth());
+	TRACE_SET_POINTS(points.size());
+	const auto extraGaussKernelRadius = gaussKernelRadius * 2;
+	const auto &extraKernel = KernelsFactory::gaussKernel(extraGaussKernelRadius, GaussKernelType::FULL);
+	auto descriptors = DescriptorSet();
+	descriptors.reserve(int(points.size()));
+	const auto netStep = int(ceil(gaussKernelRadius * 2 / double(descriptors.getSize())));
+	auto magnitudesBuffer = std::vector<float>();
+	auto anglesBuffer = std::vector<float>();
+	for (auto point : points) {
+		auto angles = getPointMaxGradientAngles(gradient, point, extraGaussKernelRadius, extraKernel);
+		for (auto angle : angles) {
+			const auto index = descriptors.add(point.getX(), point.getY(), angle);
+			auto cosAngle = cos(angle);
+			auto sinAngle = sin(angle);
+			for (auto i = point.getX() - extraGaussKernelRadius, kernel_i = 0; i < point.getX() + extraGaussKernelRadius; ++i, ++kernel_i) {
+				const auto magnitudes = gradient.getMagnitudeWindowRow(i, point.getY(), extraGaussKernelRadius, magnitudesBuffer);
+				const auto gradientAngles = gradient.getAngleWindowRow(i, point.getY(), extraGaussKernelRadius, anglesBuffer);
+				for (auto j = point.getY() - extraGaussKernelRadius, kernel_j = 0; j < point.getY() + extraGaussKernelRadius; ++j, ++kernel_j) {
+					auto windowRotatedX = int(round((i - point.getX()) * cosAngle - (j - point.getY()) * sinAngle));
+					auto windowRotatedY = int(round((i - point.getX()) * sinAngle + (j - point.getY()) * cosAngle));
+					if (windowRotatedX < -extraGaussKernelRadius || windowRotatedX > -1 || windowRotatedY < -extraGaussKernelRadius || windowRotatedY > -1) {
+						continue;
+					}
+					const auto gradAngleToAdd = ImageHelper::getNormalizedAngle(gradientAngles[kernel_j] - angle);
+					const auto gradLength = magnitudes[kernel_j] * extraKernel.get(kernel_i, kernel_j);
+					descriptors.addValueOnAngleWithIndex(index, (windowRotatedX + extraGaussKernelRadius) / netStep, (windowRotatedY + extraGaussKernelRadius) / netStep, gradAngleToAdd, gradLength);
+				}
+			}
+			descriptors.normalize(index);
 		}
+	}
+	return descriptors;
+}
+
+std::vector<double> DescriptorHelper::getPointMaxGradientAngles(const GradientField &gradient, const ImagePoint &point, const int gaussKernelRadius, const Image &gaussKernel)
+{
+	Descriptor largeDescriptor(BIN_ROTATION_IVARIANT_ORIENTATIONS_COUNT);
+	auto magnitudesBuffer = std::vector<float>();
+	auto anglesBuffer = std::vector<float>();
+	for (auto i = point.getX() - gaussKernelRadius, kernel_i = 0; i < point.getX() + gaussKernelRadius; ++i, ++kernel_i) {
+		const auto magnitudes = gradient.getMagnitudeWindowRow(i, point.getY(), gaussKernelRadius, magnitudesBuffer);
+		const auto angles = gradient.getAngleWindowRow(i, point.getY(), gaussKernelRadius, anglesBuffer);
+		for (auto kernel_j = 0; kernel_j < 2 * gaussKernelRadius; ++kernel_j) {
+			const auto gradLength = magnitudes[kernel_j] * gaussKernel.get(kernel_i, kernel_j);
+			largeDescriptor.addValueOnAngle(angles[kernel_j], gradLength);
+		}
+	}
+	return largeDescriptor.maxOrientationInterpolatedAngles();
+}
+
+void DescriptorHelper::drawDescriptors(QPainter &painter, const DescriptorSet &descriptors, const DescriptorSet &descriptorsOfModified, const int &imageWidth, const double &minDistanceTreshold) {
+	TRACE_SCOPE("DescriptorHelper::drawDescriptors");
+	TRACE_SET_POINTS(descriptors.getCount());
+	drawMatches(painter, descriptors, descriptorsOfModified, DescriptorMatcher::match(descriptors, descriptorsOfModified, minDistanceTreshold), imageWidth);
+}
+
+void DescriptorHelper::drawMatches(QPainter &painter, const DescriptorSet &descriptors, const DescriptorSet &descriptorsOfModified, const std::vector<DescriptorMatch> &matches, const int &imageWidth) {
+	for (const auto &match : matches) {
 		painter.setPen(QColor(abs(rand()) % 256, abs(rand()) % 256, abs(rand()) % 256));
-		painter.drawLine(descriptors[i].getY(),
-			descriptors[i].getX(),
-			descriptorsOfModified[answer].getY() + imageWidth,
-			descriptorsOfModified[answer].getX());
+		painter.drawLine(descriptors.getY(match.queryIndex),
+			descriptors.getX(match.queryIndex),
+			descriptorsOfModified.getY(match.trainIndex) + imageWidth,
+			descriptorsOfModified.getX(match.trainIndex));
 	}
 }
\ No newline at end of file
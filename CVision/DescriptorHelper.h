@@ -3,13 +3,23 @@
 
 #include <vector>
 
+#include "DescriptorMatcher.h"
+
+class Image;
 class QPainter;
-class Descriptor;
+class DescriptorSet;
+class GradientField;
+class ImagePoint;
 
 class DescriptorHelper
 {
+	static std::vector<double> getPointMaxGradientAngles(const GradientField &gradient, const ImagePoint &point, const int gaussKernelRadius, const Image &gaussKernel);
+
 public:
-	static void drawDescriptors(QPainter & painter, const std::vector<Descriptor>& descriptors, const std::vector<Descriptor>& descriptorsOfModified, const int & imageWidth, const double & minDistanceTreshold);
+	static DescriptorSet getDescriptors(const GradientField &gradient, const std::vector<ImagePoint> &points, const int gaussKernelRadius);
+	static DescriptorSet getDescriptorsRotateInvariant(const GradientField &gradient, const std::vector<ImagePoint> &points, const int gaussKernelRadius);
+	static void drawDescriptors(QPainter & painter, const DescriptorSet& descriptors, const DescriptorSet& descriptorsOfModified, const int & imageWidth, const double & minDistanceTreshold);
+	static void drawMatches(QPainter & painter, const DescriptorSet& descriptors, const DescriptorSet& descriptorsOfModified, const std::vector<DescriptorMatch>& matches, const int & imageWidth);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include "DescriptorMatcher.h"
+#include "DescriptorSet.h"
+#include "DescriptorMath.h"
+#include "QuantizedDescriptorSet.h"
+#include "BinaryDescriptorSet.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <qmath.h>
+
+namespace {
+const int QUERY_BLOCK_SIZE = 16;
+const int TRAIN_BLOCK_SIZE = 64;
+}
+
+template<int Dimension>
+void DescriptorMatcher::findNearest(const DescriptorSet &query, const DescriptorSet &train, std::vector<DescriptorMatch> &matches)
+{
+	const auto queryCount = query.getCount();
+	const auto trainCount = train.getCount();
+	const auto stride = query.getStride();
+	matches.resize(queryCount);
+	auto best = std::vector<float>(queryCount, std::numeric_limits<float>::max());
+	auto second = std::vector<float>(queryCount, std::numeric_limits<float>::max());
+	auto bestIndex = std::vector<int>(queryCount, -1);
+	const auto blocksCount = (queryCount + QUERY_BLOCK_SIZE - 1) / QUERY_BLOCK_SIZE;
+	ThreadPool::instance().parallelFor(0, blocksCount, [&](const int blockBegin, const int blockEnd) {
+		for (auto block = blockBegin; block < blockEnd; ++block) {
+			const auto queryBegin = block * QUERY_BLOCK_SIZE;
+			const auto queryEnd = std::min(queryCount, queryBegin + QUERY_BLOCK_SIZE);
+			for (auto trainBegin = 0; trainBegin < trainCount; trainBegin += TRAIN_BLOCK_SIZE) {
+				const auto trainEnd = std::min(trainCount, trainBegin + TRAIN_BLOCK_SIZE);
+				for (auto i = queryBegin; i < queryEnd; ++i) {
+					const auto queryRow = query.getRow(i);
+					for (auto j = trainBegin; j < trainEnd; ++j) {
+						const auto distance = DescriptorMath<Dimension>::squaredDistance(queryRow, train.getRow(j), stride, second[i]);
+						if (distance < best[i]) {
+							second[i] = best[i];
+							best[i] = distance;
+							bestIndex[i] = j;
+						}
+						else if (distance < second[i]) {
+							second[i] = distance;
+						}
+					}
+				}
+			}
+		}
+	});
+	for (auto i = 0; i < queryCount; ++i) {
+		matches[i].queryIndex = i;
+		matches[i].trainIndex = bestIndex[i];
+		matches[i].distance = sqrt(double(best[i]));
+		matches[i].secondDistance = second[i] == std::numeric_limits<float>::max()
+			? std::numeric_limits<double>::infinity()
+			: sqrt(double(second[i]));
+	}
+}
+
+void DescriptorMatcher::findNearest(const DescriptorSet &query, const DescriptorSet &train, std::vector<DescriptorMatch> &matches)
+{
+	Q_ASSERT(query.sameLayout(train));
+	if (query.getStride() == DEFAULT_DESCRIPTOR_DIMENSION) {
+		findNearest<DEFAULT_DESCRIPTOR_DIMENSION>(query, train, matches);
+	}
+	else {
+		findNearest<0>(query, train, matches);
+	}
+}
+
+std::vector<DescriptorMatch> DescriptorMatcher::match(const DescriptorSet &query, const DescriptorSet &train, const double maxDistance, const double ratio, const bool crossCheck)
+{
+	TRACE_SCOPE("DescriptorMatcher::match");
+	TRACE_SET_POINTS(query.getCount());
+	auto nearest = std::vector<DescriptorMatch>();
+	findNearest(query, train, nearest);
+	auto reverse = std::vector<DescriptorMatch>();
+	if (crossCheck) {
+		findNearest(train, query, reverse);
+	}
+	return select(nearest, reverse, maxDistance, ratio, crossCheck);
+}
+
+// Keeps the candidatesCount nearest train rows of every query row, nearest
+// first; missing candidates have index -1.
+template<typename CompactSet>
+void DescriptorMatcher::findCandidates(const CompactSet &query, const CompactSet &train, const int candidatesCount, std::vector<Candidate> &candidates)
+{
+	Q_ASSERT(query.sameLayout(train) && candidatesCount > 0);
+	const auto queryCount = query.getCount();
+	const auto trainCount = train.getCount();
+	candidates.assign(size_t(queryCount) * candidatesCount, Candidate{ std::numeric_limits<int>::max(), -1 });
+	const auto blocksCount = (queryCount + QUERY_BLOCK_SIZE - 1) / QUERY_BLOCK_SIZE;
+	ThreadPool::instance().parallelFor(0, blocksCount, [&](const int blockBegin, const int blockEnd) {
+		int distances[TRAIN_BLOCK_SIZE];
+		for (auto block = blockBegin; block < blockEnd; ++block) {
+			const auto queryBegin = block * QUERY_BLOCK_SIZE;
+			const auto queryEnd = std::min(queryCount, queryBegin + QUERY_BLOCK_SIZE);
+			for (auto trainBegin = 0; trainBegin < trainCount; trainBegin += TRAIN_BLOCK_SIZE) {
+				const auto trainEnd = std::min(trainCount, trainBegin + TRAIN_BLOCK_SIZE);
+				for (auto i = queryBegin; i < queryEnd; ++i) {
+					query.getRawDistances(i, train, trainBegin, trainEnd, distances);
+					const auto nearest = &candidates[size_t(i) * candidatesCount];
+					for (auto j = trainBegin; j < trainEnd; ++j) {
+						const auto distance = distances[j - trainBegin];
+						if (distance >= nearest[candidatesCount - 1].distance) {
+							continue;
+						}
+						auto k = candidatesCount - 1;
+						for (; k > 0 && distance < nearest[k - 1].distance; --k) {
+							nearest[k] = nearest[k - 1];
+						}
+						nearest[k] = Candidate{ distance, j };
+					}
+				}
+			}
+		}
+	});
+}
+
+template<typename CompactSet>
+void DescriptorMatcher::findNearestCompact(const CompactSet &query, const CompactSet &train, std::vector<DescriptorMatch> &matches)
+{
+	auto candidates = std::vector<Candidate>();
+	findCandidates(query, train, 2, candidates);
+	matches.resize(query.getCount());
+	for (auto i = 0; i < query.getCount(); ++i) {
+		const auto &best = candidates[2 * size_t(i)];
+		const auto &second = candidates[2 * size_t(i) + 1];
+		matches[i].queryIndex = i;
+		matches[i].trainIndex = best.index;
+		matches[i].distance = best.index < 0 ? std::numeric_limits<double>::infinity() : CompactSet::toDistance(best.distance);
+		matches[i].secondDistance = second.index < 0 ? std::numeric_limits<double>::infinity() : CompactSet::toDistance(second.distance);
+	}
+}
+
+template<typename CompactSet>
+std::vector<DescriptorMatch> DescriptorMatcher::matchCompact(const CompactSet &query, const CompactSet &train, const double maxDistance, const double ratio, const bool crossCheck)
+{
+	auto nearest = std::vector<DescriptorMatch>();
+	findNearestCompact(query, train, nearest);
+	auto reverse = std::vector<DescriptorMatch>();
+	if (crossCheck) {
+		findNearestCompact(train, query, reverse);
+	}
+	return select(nearest, reverse, maxDistance, ratio, crossCheck);
+}
+
+template<typename CompactSet>
+std::vector<DescriptorMatch> DescriptorMatcher::rerank(const CompactSet &query,
+	const CompactSet &train,
+	const DescriptorSet &queryFull,
+	const DescriptorSet &trainFull,
+	const int candidatesCount,
+	const double maxDistance,
+	const double ratio)
+{
+	Q_ASSERT(query.getCount() == queryFull.getCount() && train.getCount() == trainFull.getCount());
+	auto candidates = std::vector<Candidate>();
+	findCandidates(query, train, candidatesCount, candidates);
+	auto nearest = std::vector<DescriptorMatch>(query.getCount());
+	ThreadPool::instance().parallelFor(0, query.getCount(), [&](const int queryBegin, const int queryEnd) {
+		for (auto i = queryBegin; i < queryEnd; ++i) {
+			auto best = std::numeric_limits<float>::max();
+			auto second = std::numeric_limits<float>::max();
+			auto bestIndex = -1;
+			for (auto k = 0; k < candidatesCount; ++k) {
+				const auto j = candidates[size_t(i) * candidatesCount + k].index;
+				if (j < 0) {
+					break;
+				}
+				const auto distance = queryFull.squaredDistance(i, trainFull, j, second);
+				if (distance < best) {
+					second = best;
+					best = distance;
+					bestIndex = j;
+				}
+				else if (distance < second) {
+					second = distance;
+				}
+			}
+			nearest[i].queryIndex = i;
+			nearest[i].trainIndex = bestIndex;
+			nearest[i].distance = bestIndex < 0 ? std::numeric_limits<double>::infinity() : sqrt(double(best));
+			nearest[i].secondDistance = second == std::numeric_limits<float>::max()
+				? std::numeric_limits<double>::infinity()
+				: sqrt(double(second));
+		}
+	});
+	return select(nearest, std::vector<DescriptorMatch>(), maxDistance, ratio, false);
+}
+
+std::vector<DescriptorMatch> DescriptorMatcher::match(const QuantizedDescriptorSet &query, const QuantizedDescriptorSet &train, const double maxDistance, const double ratio, const bool crossCheck)
+{
+	TRACE_SCOPE("DescriptorMatcher::matchQuantized");
+	TRACE_SET_POINTS(query.getCount());
+	return matchCompact(query, train, maxDistance, ratio, crossCheck);
+}
+
+std::vector<DescriptorMatch> DescriptorMatcher::match(const BinaryDescriptorSet &query, const BinaryDescriptorSet &train, const double maxDistance, const double ratio, const bool crossCheck)
+{
+	TRACE_SCOPE("DescriptorMatcher::matchBinary");
+	TRACE_SET_POINTS(query.getCount());
+	return matchCompact(query, train, maxDistance, ratio, crossCheck);
+}
+
+std::vector<DescriptorMatch> DescriptorMatcher::matchReranked(const QuantizedDescriptorSet &query,
+	const QuantizedDescriptorSet &train,
+	const DescriptorSet &queryFull,
+	const DescriptorSet &trainFull,
+	const int candidatesCount,
+	const double maxDistance,
+	const double ratio)
+{
+	TRACE_SCOPE("DescriptorMatcher::matchRerankedQuantized");
+	TRACE_SET_POINTS(query.getCount());
+	return rerank(query, train, queryFull, trainFull, candidatesCount, maxDistance, ratio);
+}
+
+std::vector<DescriptorMatch> DescriptorMatcher::matchReranked(const BinaryDescriptorSet &query,
+	const BinaryDescriptorSet &train,
+	const DescriptorSet &queryFull,
+	const DescriptorSet &trainFull,
+	const int candidatesCount,
+	const double maxDistance,
+	const double ratio)
+{
+	TRACE_SCOPE("DescriptorMatcher::matchRerankedBinary");
+	TRACE_SET_POINTS(query.getCount());
+	return rerank(query, train, queryFull, trainFull, candidatesCount, maxDistance, ratio);
+}
+
+std::vector<DescriptorMatch> DescriptorMatcher::select(const std::vector<DescriptorMatch> &nearest,
+	const std::vector<DescriptorMatch> &reverse,
+	const double maxDistance,
+	const double ratio,
+	const bool crossCheck)
+{
+	auto result = std::vector<DescriptorMatch>();
+	for (const auto &match : nearest) {
+		if (match.trainIndex < 0 || match.distance > maxDistance) {
+			continue;
+		}
+		if (ratio < 1 && !(match.distance < ratio * match.secondDistance)) {
+			continue;
+		}
+		if (crossCheck && reverse[match.trainIndex].trainIndex != match.queryIndex) {
+			continue;
+		}
+		result.push_back(match);
+	}
+	return result;
+}
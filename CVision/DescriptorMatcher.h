@@ -0,0 +1,92 @@
+#ifndef COMPUTERVISION_DESCRIPTORMATCHER_H
+#define COMPUTERVISION_DESCRIPTORMATCHER_H
+
+#include <vector>
+#include <limits>
+#include "ConstantValues.h"
+
+class DescriptorSet;
+class QuantizedDescriptorSet;
+class BinaryDescriptorSet;
+
+struct DescriptorMatch {
+	int queryIndex;
+	int trainIndex;
+	double distance;
+	double secondDistance;
+};
+
+// Exact nearest-neighbour matcher: squared distances with early abandoning,
+// query/train blocking and query blocks spread over the thread pool.
+// ratio keeps matches with distance < ratio * secondDistance (1 disables it),
+// crossCheck keeps only mutual nearest neighbours.
+// Quantized and binary sets are matched the same way on integer distances;
+// matchReranked takes their candidatesCount nearest rows and picks the match
+// among them with the full-precision rows of the source sets.
+class DescriptorMatcher
+{
+	struct Candidate {
+		int distance;
+		int index;
+	};
+
+	template<int Dimension>
+	static void findNearest(const DescriptorSet &query, const DescriptorSet &train, std::vector<DescriptorMatch> &matches);
+	static void findNearest(const DescriptorSet &query, const DescriptorSet &train, std::vector<DescriptorMatch> &matches);
+	template<typename CompactSet>
+	static void findCandidates(const CompactSet &query, const CompactSet &train, const int candidatesCount, std::vector<Candidate> &candidates);
+	template<typename CompactSet>
+	static void findNearestCompact(const CompactSet &query, const CompactSet &train, std::vector<DescriptorMatch> &matches);
+	template<typename CompactSet>
+	static std::vector<DescriptorMatch> matchCompact(const CompactSet &query, const CompactSet &train, const double maxDistance, const double ratio, const bool crossCheck);
+	template<typename CompactSet>
+	static std::vector<DescriptorMatch> rerank(const CompactSet &query,
+		const CompactSet &train,
+		const DescriptorSet &queryFull,
+		const DescriptorSet &trainFull,
+		const int candidatesCount,
+		const double maxDistance,
+		const double ratio);
+	static std::vector<DescriptorMatch> select(const std::vector<DescriptorMatch> &nearest,
+		const std::vector<DescriptorMatch> &reverse,
+		const double maxDistance,
+		const double ratio,
+		const bool crossCheck);
+
+public:
+	static std::vector<DescriptorMatch> match(const DescriptorSet &query,
+		const DescriptorSet &train,
+		const double maxDistance = std::numeric_limits<double>::max(),
+		const double ratio = 1,
+		const bool crossCheck = false);
+	// Distances are in the units of the float sets.
+	static std::vector<DescriptorMatch> match(const QuantizedDescriptorSet &query,
+		const QuantizedDescriptorSet &train,
+		const double maxDistance = std::numeric_limits<double>::max(),
+		const double ratio = 1,
+		const bool crossCheck = false);
+	// Distances are Hamming distances in bits.
+	static std::vector<DescriptorMatch> match(const BinaryDescriptorSet &query,
+		const BinaryDescriptorSet &train,
+		const double maxDistance = std::numeric_limits<double>::max(),
+		const double ratio = 1,
+		const bool crossCheck = false);
+
+	// Distances are full-precision; the sets must come from queryFull and trainFull.
+	static std::vector<DescriptorMatch> matchReranked(const QuantizedDescriptorSet &query,
+		const QuantizedDescriptorSet &train,
+		const DescriptorSet &queryFull,
+		const DescriptorSet &trainFull,
+		const int candidatesCount = DESCRIPTOR_RERANK_CANDIDATES,
+		const double maxDistance = std::numeric_limits<double>::max(),
+		const double ratio = 1);
+	static std::vector<DescriptorMatch> matchReranked(const BinaryDescriptorSet &query,
+		const BinaryDescriptorSet &train,
+		const DescriptorSet &queryFull,
+		const DescriptorSet &trainFull,
+		const int candidatesCount = DESCRIPTOR_RERANK_CANDIDATES,
+		const double maxDistance = std::numeric_limits<double>::max(),
+		const double ratio = 1);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef COMPUTERVISION_DESCRIPTORMATH_H
+#define COMPUTERVISION_DESCRIPTORMATH_H
+
+#include <cmath>
+
+const auto DESCRIPTOR_MATH_LANES = 8;
+const auto DESCRIPTOR_ABANDON_STEP = 32;
+
+// Loops over descriptor rows padded with zeros to a multiple of
+// DESCRIPTOR_MATH_LANES; independent lane sums keep them vectorizable
+// without reassociating float additions.
+class DescriptorMathBase
+{
+protected:
+	static float squaredDistance(const float *a, const float *b, const int dimension, const float abandonAbove)
+	{
+		float lanes[DESCRIPTOR_MATH_LANES] = {};
+		auto length = 0.f;
+		for (auto begin = 0; begin < dimension; begin += DESCRIPTOR_ABANDON_STEP) {
+			for (auto i = begin; i < begin + DESCRIPTOR_ABANDON_STEP && i < dimension; i += DESCRIPTOR_MATH_LANES) {
+				for (auto k = 0; k < DESCRIPTOR_MATH_LANES; ++k) {
+					const auto difference = a[i + k] - b[i + k];
+					lanes[k] += difference * difference;
+				}
+			}
+			length = 0;
+			for (auto k = 0; k < DESCRIPTOR_MATH_LANES; ++k) {
+				length += lanes[k];
+			}
+			if (length > abandonAbove) {
+				return length;
+			}
+		}
+		return length;
+	}
+
+	static void normalize(float *data, const int dimension)
+	{
+		float lanes[DESCRIPTOR_MATH_LANES] = {};
+		for (auto i = 0; i < dimension; i += DESCRIPTOR_MATH_LANES) {
+			for (auto k = 0; k < DESCRIPTOR_MATH_LANES; ++k) {
+				lanes[k] += data[i + k] * data[i + k];
+			}
+		}
+		auto length = 0.f;
+		for (auto k = 0; k < DESCRIPTOR_MATH_LANES; ++k) {
+			length += lanes[k];
+		}
+		const auto inverseLength = 1.f / std::sqrt(length);
+		for (auto i = 0; i < dimension; ++i) {
+			data[i] *= inverseLength;
+		}
+	}
+};
+
+// Dimension fixes the padded row length at compile time so the loops above are
+// fully unrolled; DescriptorMath<0> takes the length at runtime instead.
+template<int Dimension>
+class DescriptorMath : DescriptorMathBase
+{
+	static_assert(Dimension % DESCRIPTOR_MATH_LANES == 0, "descriptor dimension must be a multiple of lanes count");
+
+public:
+	static float squaredDistance(const float *a, const float *b, const int, const float abandonAbove)
+	{
+		return DescriptorMathBase::squaredDistance(a, b, Dimension, abandonAbove);
+	}
+
+	static void normalize(float *data, const int)
+	{
+		DescriptorMathBase::normalize(data, Dimension);
+	}
+};
+
+template<>
+class DescriptorMath<0> : DescriptorMathBase
+{
+public:
+	static float squaredDistance(const float *a, const float *b, const int dimension, const float abandonAbove)
+	{
+		return DescriptorMathBase::squaredDistance(a, b, dimension, abandonAbove);
+	}
+
+	static void normalize(float *data, const int dimension)
+	{
+		DescriptorMathBase::normalize(data, dimension);
+	}
+};
+
+#endif
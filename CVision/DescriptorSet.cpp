@@ -0,0 +1,91 @@
+#include "DescriptorSet.h"
+#include "DescriptorMath.h"
+#include <algorithm>
+#include <qmath.h>
+
+DescriptorSet::DescriptorSet(const int size, const int orientationsCount)
+	: _size(size), _orientationsCount(orientationsCount), _dimension(size * size * orientationsCount),
+	_stride((_dimension + DESCRIPTOR_ROW_ALIGNMENT - 1) / DESCRIPTOR_ROW_ALIGNMENT * DESCRIPTOR_ROW_ALIGNMENT) {
+}
+
+void DescriptorSet::reserve(const int count)
+{
+	_data.reserve(size_t(count) * _stride);
+	_x.reserve(count);
+	_y.reserve(count);
+	_angle.reserve(count);
+}
+
+int DescriptorSet::add(const int x, const int y, const double angle)
+{
+	_data.resize(_data.size() + _stride, 0.f);
+	_x.push_back(x);
+	_y.push_back(y);
+	_angle.push_back(angle);
+	return getCount() - 1;
+}
+
+void DescriptorSet::append(const DescriptorSet &other)
+{
+	Q_ASSERT(sameLayout(other));
+	_data.insert(_data.end(), other._data.begin(), other._data.end());
+	_x.insert(_x.end(), other._x.begin(), other._x.end());
+	_y.insert(_y.end(), other._y.begin(), other._y.end());
+	_angle.insert(_angle.end(), other._angle.begin(), other._angle.end());
+}
+
+int DescriptorSet::addCopy(const DescriptorSet &other, const int index, const int x, const int y)
+{
+	Q_ASSERT(sameLayout(other));
+	const auto result = add(x, y, other.getAngle(index));
+	std::copy(other.getRow(index), other.getRow(index) + _stride, getRow(result));
+	return result;
+}
+
+void DescriptorSet::addValueOnAngleWithIndex(const int index, const int i, const int j, const double angle, const double value)
+{
+	Q_ASSERT(i >= 0 && i < _size && j >= 0 && j < _size);
+	const auto binStep = 2 * M_PI / _orientationsCount;
+	const auto binFirst = int(angle / binStep);
+	const auto binSecond =
+		angle - binStep * binFirst >= binStep / 2
+		? (binFirst + 1) % _orientationsCount
+		: binFirst == 0
+		? _orientationsCount - 1
+		: binFirst - 1;
+
+	const auto proportionalForFirst = (angle - binStep * binFirst) / binStep;
+	const auto proportionalForSecond = 1 - proportionalForFirst;
+	auto row = getRow(index);
+	row[i * _size * _orientationsCount + j * _orientationsCount + binFirst] += float(value * proportionalForFirst);
+	row[i * _size * _orientationsCount + j * _orientationsCount + binSecond] += float(value * proportionalForSecond);
+}
+
+void DescriptorSet::normalize(const int index)
+{
+	if (_stride == DEFAULT_DESCRIPTOR_DIMENSION) {
+		DescriptorMath<DEFAULT_DESCRIPTOR_DIMENSION>::normalize(getRow(index), _stride);
+	}
+	else {
+		DescriptorMath<0>::normalize(getRow(index), _stride);
+	}
+}
+
+float DescriptorSet::squaredDistance(const int index, const DescriptorSet &other, const int otherIndex, const float abandonAbove) const
+{
+	Q_ASSERT(sameLayout(other));
+	if (_stride == DEFAULT_DESCRIPTOR_DIMENSION) {
+		return DescriptorMath<DEFAULT_DESCRIPTOR_DIMENSION>::squaredDistance(getRow(index), other.getRow(otherIndex), _stride, abandonAbove);
+	}
+	return DescriptorMath<0>::squaredDistance(getRow(index), other.getRow(otherIndex), _stride, abandonAbove);
+}
+
+double DescriptorSet::distance(const int index, const DescriptorSet &other, const int otherIndex) const
+{
+	return sqrt(squaredDistance(index, other, otherIndex));
+}
+
+bool DescriptorSet::sameLayout(const DescriptorSet &other) const
+{
+	return _size == other._size && _orientationsCount == other._orientationsCount;
+}
@@ -0,0 +1,57 @@
+#ifndef COMPUTERVISION_DESCRIPTORSET_H
+#define COMPUTERVISION_DESCRIPTORSET_H
+
+#include <vector>
+#include <limits>
+#include <qglobal.h>
+#include "AlignedAllocator.h"
+#include "ConstantValues.h"
+
+// All descriptors of an image in one aligned row-major float matrix with the
+// keypoint data in parallel arrays. Rows are padded with zeros to a multiple
+// of DESCRIPTOR_ROW_ALIGNMENT floats, so every row starts aligned.
+class DescriptorSet {
+	int _size;
+	int _orientationsCount;
+	int _dimension;
+	int _stride;
+	std::vector<float, AlignedAllocator<float>> _data;
+	std::vector<int> _x, _y;
+	std::vector<double> _angle;
+
+public:
+	DescriptorSet(const int size = DEFAULT_DESCRIPTOR_SIZE, const int orientationsCount = DEFAULT_DESCRIPTOR_ORIENTATIONS_COUNT);
+
+	int getCount() const { return int(_x.size()); }
+	bool empty() const { return _x.empty(); }
+	int getSize() const { return _size; }
+	int getOrientationsCount() const { return _orientationsCount; }
+	int getDimension() const { return _dimension; }
+	int getStride() const { return _stride; }
+
+	int getX(const int index) const { return _x[index]; }
+	int getY(const int index) const { return _y[index]; }
+	double getAngle(const int index) const { return _angle[index]; }
+
+	const float *getRow(const int index) const {
+		Q_ASSERT(index >= 0 && index < getCount());
+		return _data.data() + size_t(index) * _stride;
+	}
+
+	float *getRow(const int index) {
+		Q_ASSERT(index >= 0 && index < getCount());
+		return _data.data() + size_t(index) * _stride;
+	}
+
+	void reserve(const int count);
+	int add(const int x, const int y, const double angle = 0);
+	void append(const DescriptorSet &other);
+	int addCopy(const DescriptorSet &other, const int index, const int x, const int y);
+	void addValueOnAngleWithIndex(const int index, const int i, const int j, const double angle, const double value);
+	void normalize(const int index);
+	float squaredDistance(const int index, const DescriptorSet &other, const int otherIndex, const float abandonAbove = std::numeric_limits<float>::max()) const;
+	double distance(const int index, const DescriptorSet &other, const int otherIndex) const;
+	bool sameLayout(const DescriptorSet &other) const;
+};
+
+#endif
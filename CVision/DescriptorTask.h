@@ -1,27 +1,28 @@
 #include <vector>
 #include "Image.h"
 #include "ImageHelper.h"
+#include "GradientField.h"
+#include "DescriptorHelper.h"
 #include "ConstantValues.h"
 
-class Descriptor;
 class ImagePoint;
 
 class DescriptorTaskBase
 {
 public:
-	virtual std::vector<Descriptor> getDescriptors(const Image &image, const std::vector<ImagePoint> &interestingPoints) = 0;
+	virtual DescriptorSet getDescriptors(const GradientField &gradient, const std::vector<ImagePoint> &interestingPoints) = 0;
 };
 
 class DescriptorTaskBasic : public DescriptorTaskBase {
-	virtual std::vector<Descriptor> getDescriptors(const Image &image, const std::vector<ImagePoint> &interestingPoints)
+	virtual DescriptorSet getDescriptors(const GradientField &gradient, const std::vector<ImagePoint> &interestingPoints)
 	{
-		return image.getDescriptors(interestingPoints, GAUSS_KERNEL_RADIUS);
+		return DescriptorHelper::getDescriptors(gradient, interestingPoints, GAUSS_KERNEL_RADIUS);
 	}
 };
 
 class DescriptorTaskRotateInvariant : public DescriptorTaskBase {
-	virtual std::vector<Descriptor> getDescriptors(const Image &image, const std::vector<ImagePoint> &interestingPoints)
+	virtual DescriptorSet getDescriptors(const GradientField &gradient, const std::vector<ImagePoint> &interestingPoints)
 	{
-		return image.getDescriptorsRotateInvariant(interestingPoints, GAUSS_KERNEL_RADIUS);
+		return DescriptorHelper::getDescriptorsRotateInvariant(gradient, interestingPoints, GAUSS_KERNEL_RADIUS);
 	}
 };
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "FramePipeline.h"
+#include "FrameSource.h"
+#include "BoundedQueue.h"
+#include "GradientField.h"
+#include "DescriptorHelper.h"
+#include <memory>
+#include <thread>
+
+namespace {
+
+struct Frame {
+	int index = 0;
+	Image image;
+	std::vector<ImagePoint> points;
+	DescriptorSet descriptors;
+};
+
+typedef std::unique_ptr<Frame> FramePtr;
+
+// Closes the queues and joins the stages on every exit from run, so an
+// exception thrown by consume does not destroy joinable threads.
+class StagesGuard
+{
+	std::vector<std::thread> &_stages;
+	std::function<void()> _close;
+
+public:
+	StagesGuard(std::vector<std::thread> &stages, std::function<void()> close)
+		: _stages(stages), _close(std::move(close)) {}
+	StagesGuard(const StagesGuard &) = delete;
+	StagesGuard &operator=(const StagesGuard &) = delete;
+
+	~StagesGuard()
+	{
+		_close();
+		for (auto &stage : _stages) {
+			stage.join();
+		}
+	}
+};
+}
+
+FramePipeline::FramePipeline(const bool rotateInvariant, const double maxMatchDistance, const int queueCapacity)
+	: _rotateInvariant(rotateInvariant), _maxMatchDistance(maxMatchDistance), _queueCapacity(queueCapacity)
+{
+	Q_ASSERT(queueCapacity > 0);
+}
+
+int FramePipeline::run(FrameSource &source, const std::function<void(const FrameResult &)> &consume) const
+{
+	// One buffer per stage plus the queued ones.
+	const auto framesCount = _queueCapacity + 3;
+	BoundedQueue<FramePtr> recycled(framesCount);
+	BoundedQueue<FramePtr> decoded(_queueCapacity);
+	BoundedQueue<FramePtr> detected(_queueCapacity);
+	BoundedQueue<FramePtr> described(_queueCapacity);
+	for (auto i = 0; i < framesCount; ++i) {
+		recycled.push(std::make_unique<Frame>());
+	}
+
+	auto stages = std::vector<std::thread>();
+	stages.reserve(3);
+	const StagesGuard guard(stages, [&] {
+		recycled.close();
+		decoded.close();
+		detected.close();
+		described.close();
+	});
+	stages.emplace_back([&] {
+		auto frame = FramePtr();
+		for (auto index = 0; recycled.pop(frame) && source.read(frame->image); ++index) {
+			frame->index = index;
+			decoded.push(std::move(frame));
+		}
+		decoded.close();
+	});
+	stages.emplace_back([&] {
+		auto frame = FramePtr();
+		while (decoded.pop(frame)) {
+			const auto &image = frame->image;
+			frame->points = image.nonMaxSuppression(
+				image.harris(HARRIS_SIGMA, BorderEffectType::COPY, HarrisMode::FUSED).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD),
+				POINTS_LIMIT,
+				NONMAX_FILTER_VALUE);
+			detected.push(std::move(frame));
+		}
+		detected.close();
+	});
+	stages.emplace_back([&] {
+		auto frame = FramePtr();
+		while (detected.pop(frame)) {
+			const auto gradient = GradientField(frame->image);
+			frame->descriptors = _rotateInvariant
+				? DescriptorHelper::getDescriptorsRotateInvariant(gradient, frame->points, GAUSS_KERNEL_RADIUS)
+				: DescriptorHelper::getDescriptors(gradient, frame->points, GAUSS_KERNEL_RADIUS);
+			described.push(std::move(frame));
+		}
+		described.close();
+	});
+
+	auto processed = 0;
+	auto previous = DescriptorSet();
+	auto frame = FramePtr();
+	while (described.pop(frame)) {
+		auto result = FrameResult{ frame->index, frame->image.getHeight(), frame->image.getWidth(),
+			std::move(frame->points), std::move(frame->descriptors), std::vector<DescriptorMatch>() };
+		recycled.push(std::move(frame));
+		if (processed > 0) {
+			result.matches = DescriptorMatcher::match(result.descriptors, previous, _maxMatchDistance);
+		}
+		consume(result);
+		previous = std::move(result.descriptors);
+		++processed;
+	}
+	return processed;
+}
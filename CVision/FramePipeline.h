@@ -0,0 +1,45 @@
+#ifndef COMPUTERVISION_FRAMEPIPELINE_H
+#define COMPUTERVISION_FRAMEPIPELINE_H
+
+#include <vector>
+#include <limits>
+#include <functional>
+#include "ImagePoint.h"
+#include "DescriptorSet.h"
+#include "DescriptorMatcher.h"
+#include "ConstantValues.h"
+
+class FrameSource;
+
+struct FrameResult {
+	int index;
+	int height;
+	int width;
+	std::vector<ImagePoint> points;
+	DescriptorSet descriptors;
+	// descriptors (query) against the previous frame (train); empty for the first frame.
+	std::vector<DescriptorMatch> matches;
+};
+
+// Harris points, descriptors and frame-to-frame matches for an image sequence.
+// Decoding, detection and description run on their own threads connected by
+// bounded queues, so consecutive frames overlap; the stages themselves still use
+// the thread pool. A fixed set of frame buffers circulates through the stages
+// and back to the decoder, which also bounds the frames in flight.
+// Matching and consume run on the calling thread in frame order.
+class FramePipeline
+{
+	bool _rotateInvariant;
+	double _maxMatchDistance;
+	int _queueCapacity;
+
+public:
+	explicit FramePipeline(const bool rotateInvariant = false,
+		const double maxMatchDistance = std::numeric_limits<double>::max(),
+		const int queueCapacity = FRAME_QUEUE_CAPACITY);
+
+	// Returns the number of processed frames.
+	int run(FrameSource &source, const std::function<void(const FrameResult &)> &consume) const;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "FrameSource.h"
+#include <algorithm>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QCollator>
+
+FrameDirectorySource::FrameDirectorySource(const QString &folder, const QString &nameFilter, const GrayScaleMod grayScaleMod)
+	: _grayScaleMod(grayScaleMod)
+{
+	const auto directory = QDir(folder);
+	auto names = directory.entryList(QStringList{ nameFilter }, QDir::Files, QDir::NoSort);
+	QCollator collator;
+	collator.setNumericMode(true);
+	std::sort(names.begin(), names.end(), [&](const QString &a, const QString &b) {
+		return collator.compare(a, b) < 0;
+	});
+	for (const auto &name : names) {
+		_files.push_back(directory.filePath(name));
+	}
+}
+
+bool FrameDirectorySource::read(Image &frame)
+{
+	while (_next < getFramesCount()) {
+		const auto image = QImage(_files[_next++]);
+		if (image.isNull()) {
+			continue;
+		}
+		Image::fromQImageInto(image, _grayScaleMod, frame);
+		return true;
+	}
+	return false;
+}
+
+RawFrameSource::RawFrameSource(const QString &fileName, const int height, const int width, const RawFrameFormat format)
+	: _file(std::make_unique<QFile>(fileName)), _height(height), _width(width), _format(format)
+{
+	const auto lumaSize = size_t(height) * width;
+	const auto chromaSize = size_t((height + 1) / 2) * ((width + 1) / 2);
+	_buffer.resize(format == RawFrameFormat::YUV420P ? lumaSize + 2 * chromaSize : lumaSize);
+	_file->open(QIODevice::ReadOnly);
+}
+
+RawFrameSource::~RawFrameSource()
+{
+}
+
+bool RawFrameSource::read(Image &frame)
+{
+	if (_file->read(_buffer.data(), qint64(_buffer.size())) != qint64(_buffer.size())) {
+		return false;
+	}
+	if (frame.getHeight() != _height || frame.getWidth() != _width) {
+		frame = Image::createUninitialized(_height, _width);
+	}
+	const auto luma = reinterpret_cast<const uchar *>(_buffer.data());
+	auto destination = frame.getData();
+	for (size_t i = 0; i < size_t(_height) * _width; ++i) {
+		destination[i] = float(luma[i]) / 255;
+	}
+	return true;
+}
@@ -0,0 +1,56 @@
+#ifndef COMPUTERVISION_FRAMESOURCE_H
+#define COMPUTERVISION_FRAMESOURCE_H
+
+#include <vector>
+#include <memory>
+#include <QString>
+#include <QStringList>
+#include "Image.h"
+
+class QFile;
+
+// Sequence of grayscale frames. read decodes the next frame into frame and
+// reuses its storage, so a caller cycling a few Images never allocates per frame.
+class FrameSource
+{
+public:
+	virtual ~FrameSource() {}
+	virtual bool read(Image &frame) = 0;
+};
+
+// Every image in folder matching nameFilter, in natural order of the names
+// (frame_2 before frame_10). Files that cannot be decoded are skipped.
+class FrameDirectorySource : public FrameSource
+{
+	QStringList _files;
+	int _next = 0;
+	GrayScaleMod _grayScaleMod;
+
+public:
+	explicit FrameDirectorySource(const QString &folder, const QString &nameFilter = "*", const GrayScaleMod grayScaleMod = GrayScaleMod::SRGB_HDTV);
+
+	int getFramesCount() const { return int(_files.size()); }
+	virtual bool read(Image &frame);
+};
+
+// GRAY8 is one byte per pixel, YUV420P is a planar I420 frame of which only the
+// full-range luma plane is used.
+enum class RawFrameFormat { GRAY8, YUV420P };
+
+// Headerless stream of fixed-size frames, such as a camera dump.
+class RawFrameSource : public FrameSource
+{
+	std::unique_ptr<QFile> _file;
+	int _height,
+		_width;
+	RawFrameFormat _format;
+	std::vector<char> _buffer;
+
+public:
+	RawFrameSource(const QString &fileName, const int height, const int width, const RawFrameFormat format = RawFrameFormat::GRAY8);
+	~RawFrameSource();
+
+	virtual bool read(Image &frame);
+};
+
+#endif
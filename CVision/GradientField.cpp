@@ -0,0 +1,28 @@
+#include "GradientField.h"
+#include "ImageHelper.h"
+#include "SimdKernels.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <qmath.h>
+
+GradientField::GradientField(const Image &image, const BorderEffectType borderEffect, const int halo)
+{
+	TRACE_SCOPE_IMAGE("GradientField", image.getHeight(), image.getWidth());
+	const auto gradX = image.sobelX(borderEffect);
+	const auto gradY = image.sobelY(borderEffect);
+	auto magnitude = Image::createUninitialized(image.getHeight(), image.getWidth());
+	auto angle = Image::createUninitialized(image.getHeight(), image.getWidth());
+	const auto width = image.getWidth();
+	const auto maxAngle = std::nextafter(float(2 * M_PI), 0.f);
+	ThreadPool::instance().parallelFor(0, image.getHeight(), [&](const int rowBegin, const int rowEnd) {
+		const auto offset = rowBegin * width;
+		const auto size = (rowEnd - rowBegin) * width;
+		SimdKernels::hypo(magnitude.getData() + offset, gradX.getData() + offset, gradY.getData() + offset, size);
+		for (auto k = offset; k < offset + size; ++k) {
+			const auto value = ImageHelper::getNormalizedAngle(atan2(gradY.getDataValue(k), gradX.getDataValue(k)));
+			angle.getData()[k] = std::min(float(value), maxAngle);
+		}
+	});
+	_magnitude = PaddedImage<float>(magnitude, halo, borderEffect);
+	_angle = PaddedImage<float>(angle, halo, borderEffect);
+}
@@ -0,0 +1,51 @@
+#ifndef COMPUTERVISION_GRADIENTFIELD_H
+#define COMPUTERVISION_GRADIENTFIELD_H
+
+#include "Image.h"
+#include "PaddedImage.h"
+#include "ConstantValues.h"
+
+// Sobel gradient magnitude and orientation of an image, computed once so that
+// descriptor builders share them across keypoints and descriptor types.
+// Angles are normalized to [0, 2 * pi). Both maps carry a halo filled with the
+// border effect, so windows of radius up to getHalo() around image pixels are
+// read through plain row pointers; wider windows fall back to the border effect.
+class GradientField
+{
+	PaddedImage<float> _magnitude;
+	PaddedImage<float> _angle;
+
+public:
+	GradientField(const Image &image, const BorderEffectType borderEffect = BorderEffectType::COPY, const int halo = GRADIENT_FIELD_HALO);
+
+	int getHeight() const { return _magnitude.getHeight(); }
+	int getWidth() const { return _magnitude.getWidth(); }
+	int getHalo() const { return _magnitude.getHalo(); }
+	BorderEffectType getBorderEffect() const { return _magnitude.getBorderEffect(); }
+
+	bool containsWindow(const int i, const int j, const int radius) const {
+		return _magnitude.containsWindow(i, j, radius);
+	}
+
+	const float *getMagnitudeRow(const int i) const { return _magnitude.getRow(i); }
+	const float *getAngleRow(const int i) const { return _angle.getRow(i); }
+
+	// Columns [j - radius, j + radius) of row i, valid for windows beyond the halo too.
+	const float *getMagnitudeWindowRow(const int i, const int j, const int radius, std::vector<float> &buffer) const {
+		return _magnitude.getWindowRow(i, j, radius, buffer);
+	}
+
+	const float *getAngleWindowRow(const int i, const int j, const int radius, std::vector<float> &buffer) const {
+		return _angle.getWindowRow(i, j, radius, buffer);
+	}
+
+	float getMagnitude(const int i, const int j) const {
+		return _magnitude.getValue(i, j);
+	}
+
+	float getAngle(const int i, const int j) const {
+		return _angle.getValue(i, j);
+	}
+};
+
+#endif
@@ -3,34 +3,55 @@
 #include "Image.h"
 #include <QPainter>
 #include <QPen>
+#include <QImage>
 #include <qmath.h>
 #include "ConstantValues.h"
+#include "SimdKernels.h"
+#include "ThreadPool.h"
+#include "MoravecHelper.h"
+#include "SuppressionHelper.h"
+#include "GradientField.h"
+#include "DescriptorHelper.h"
+#include "PaddedImage.h"
+#include "RawImageFile.h"
+#include "Trace.h"
 
 Image::Image() {
 }
 
 Image::Image(const int height, const int width) : _height(height),
 _width(width),
-_dataSize(height * width),
-_data(std::make_unique<double[]>(_dataSize))
+_data(BufferPool::instance().allocate(size_t(height) * width))
 {
+	std::fill(begin(), end(), 0.f);
 }
 
-Image::Image(const int height, const int width, const double *data) : _height(height),
+Image Image::createUninitialized(const int height, const int width) {
+	auto result = Image();
+	result.resize(height, width);
+	return result;
+}
+
+Image::Image(const int height, const int width, const float *data) : _height(height),
 _width(width),
-_dataSize(height * width),
-_data(std::make_unique<double[]>(size_t(_dataSize))) {
-	for (auto i = 0; i < _dataSize; ++i) {
-		_data[i] = data[i];
-	}
+_data(BufferPool::instance().allocate(size_t(height) * width)) {
+	std::copy(data, data + size_t(height) * width, begin());
 }
 
 Image::Image(const Image &Image) : _height(Image._height),
 _width(Image._width),
-_dataSize(_height * _width),
-_data(std::make_unique<double[]>(size_t(_dataSize))) {
-	for (auto i = 0; i < _dataSize; ++i)
-		_data[i] = Image._data[i];
+_data(BufferPool::instance().allocate(size_t(_height) * _width)) {
+	std::copy(Image.begin(), Image.end(), begin());
+}
+
+Image::Image(Image &&image) : _height(image._height),
+_width(image._width),
+_data(std::move(image._data)) {
+	image._height = 0;
+	image._width = 0;
+}
+
+Image::Image(const ImageView &view) : Image(view.getHeight(), view.getWidth(), view.getData()) {
 }
 
 Image Image::getCopy() const {
@@ -38,11 +59,11 @@ Image Image::getCopy() const {
 }
 
 void Image::normalize() {
-	const auto minValue = *std::min_element(begin(), end());
-	const auto maxValue = *std::max_element(begin(), end());
+	auto minValue = .0f, maxValue = .0f;
+	SimdKernels::minMax(begin(), getHeight() * getWidth(), minValue, maxValue);
 	auto range = maxValue - minValue;
 	range = range == 0 ? 1 : range;
-	forEach([=](auto &value) { value = (value - minValue) / range; });
+	SimdKernels::normalize(begin(), getHeight() * getWidth(), minValue, range);
 }
 
 Image Image::getNormalized() const {
@@ -51,42 +72,125 @@ Image Image::getNormalized() const {
 	return result;
 }
 
+namespace {
+
+void getLuminanceWeights(const GrayScaleMod &grayScaleMod, float &red, float &green, float &blue) {
+	switch (grayScaleMod)
+	{
+	case GrayScaleMod::PAL_NTSC:
+		red = float(.299 / 255);
+		green = float(.587 / 255);
+		blue = float(.114 / 255);
+		break;
+	default:
+		red = float(.213 / 255);
+		green = float(.715 / 255);
+		blue = float(.072 / 255);
+		break;
+	}
+}
+}
+
 Image Image::fromQImage(const QImage &image, const GrayScaleMod &grayScaleMod) {
-	auto result = Image(image.height(), image.width());
-	for (auto i = 0; i < result.getHeight(); ++i) {
-		for (auto j = 0; j < result.getWidth(); ++j) {
-			const auto  color = image.pixel(j, i);
-			const auto  red = qRed(color),
-				green = qGreen(color),
-				blue = qBlue(color);
-			switch (grayScaleMod)
-			{
-			case GrayScaleMod::PAL_NTSC:
-				result.set(i, j, (.299 * red + .587 * green + .114 * blue) / 255);
-				break;
-			case GrayScaleMod::SRGB_HDTV:
-				result.set(i, j, (.213 * red + .715 * green + .072 * blue) / 255);
-				break;
-			default:
-				break;
+	auto result = Image();
+	fromQImageInto(image, grayScaleMod, result);
+	return result;
+}
+
+void Image::fromQImageInto(const QImage &image, const GrayScaleMod &grayScaleMod, Image &result) {
+	TRACE_SCOPE_IMAGE("Image::fromQImage", image.height(), image.width());
+	if (image.isNull()) {
+		result.resize(0, 0);
+		return;
+	}
+	result.resize(image.height(), image.width());
+	auto red = .0f, green = .0f, blue = .0f;
+	getLuminanceWeights(grayScaleMod, red, green, blue);
+	const auto width = result.getWidth();
+	switch (image.format()) {
+	case QImage::Format_Grayscale8: {
+		float table[256];
+		for (auto c = 0; c < 256; ++c) {
+			table[c] = red * float(c) + green * float(c) + blue * float(c);
+		}
+		ThreadPool::instance().parallelFor(0, result.getHeight(), [&](const int rowBegin, const int rowEnd) {
+			for (auto i = rowBegin; i < rowEnd; ++i) {
+				const auto source = image.constScanLine(i);
+				auto destination = result.begin() + size_t(i) * width;
+				for (auto j = 0; j < width; ++j) {
+					destination[j] = table[source[j]];
+				}
 			}
+		});
+		break;
+	}
+	case QImage::Format_RGB888:
+		ThreadPool::instance().parallelFor(0, result.getHeight(), [&](const int rowBegin, const int rowEnd) {
+			for (auto i = rowBegin; i < rowEnd; ++i) {
+				const auto source = image.constScanLine(i);
+				auto destination = result.begin() + size_t(i) * width;
+				for (auto j = 0; j < width; ++j) {
+					destination[j] = red * float(source[3 * j]) + green * float(source[3 * j + 1]) + blue * float(source[3 * j + 2]);
+				}
+			}
+		});
+		break;
+	case QImage::Format_RGB32:
+	case QImage::Format_ARGB32:
+		ThreadPool::instance().parallelFor(0, result.getHeight(), [&](const int rowBegin, const int rowEnd) {
+			for (auto i = rowBegin; i < rowEnd; ++i) {
+				SimdKernels::luminance(result.begin() + size_t(i) * width,
+					reinterpret_cast<const uint32_t *>(image.constScanLine(i)), red, green, blue, width);
+			}
+		});
+		break;
+	default: {
+		const auto converted = image.convertToFormat(QImage::Format_RGB32);
+		if (converted.isNull() || converted.format() != QImage::Format_RGB32) {
+			result.resize(0, 0);
+			break;
 		}
+		fromQImageInto(converted, grayScaleMod, result);
+		break;
+	}
 	}
-	return result;
 }
 
 QImage Image::toQImage() const {
 	auto image = QImage(getWidth(), getHeight(), QImage::Format_RGB32);
-	for (auto i = 0; i < getHeight(); ++i) {
-		for (auto j = 0; j < getWidth(); ++j) {
-			const auto color = int(get(i, j) * 255);
-			image.setPixel(j, i, qRgb(color, color, color));
+	// scanLine detaches the image, so resolve the buffer once before the bands write to it.
+	const auto bits = image.bits();
+	const auto bytesPerLine = size_t(image.bytesPerLine());
+	ThreadPool::instance().parallelFor(0, getHeight(), [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			const auto source = begin() + size_t(i) * getWidth();
+			auto destination = reinterpret_cast<QRgb *>(bits + i * bytesPerLine);
+			for (auto j = 0; j < getWidth(); ++j) {
+				const auto color = int(source[j] * 255);
+				destination[j] = qRgb(color, color, color);
+			}
 		}
-	}
+	});
+	return image;
+}
+
+QImage Image::toGrayscaleQImage() const {
+	auto image = QImage(getWidth(), getHeight(), QImage::Format_Grayscale8);
+	const auto bits = image.bits();
+	const auto bytesPerLine = size_t(image.bytesPerLine());
+	ThreadPool::instance().parallelFor(0, getHeight(), [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			const auto source = begin() + size_t(i) * getWidth();
+			auto destination = bits + i * bytesPerLine;
+			for (auto j = 0; j < getWidth(); ++j) {
+				destination[j] = uchar(qBound(0, int(source[j] * 255), 255));
+			}
+		}
+	});
 	return image;
 }
 
-double Image::getValue(int i, int j, BorderEffectType borderEffect) const {
+float Image::getValue(int i, int j, BorderEffectType borderEffect) const {
 	if (contains(i, j)) {
 		return get(i, j);
 	}
@@ -107,48 +211,160 @@ double Image::getValue(int i, int j, BorderEffectType borderEffect) const {
 
 Image Image::conv(const Image &kernel, const BorderEffectType borderEffect) const {
 	auto result = Image(getHeight(), getWidth());
-	for (auto i = 0; i < getHeight(); ++i) {
-		for (auto j = 0; j < getWidth(); ++j) {
-			auto value = .0;
+	const auto lineSize = getWidth() + kernel.getWidth() - 1;
+	auto padded = std::vector<float>(size_t(getHeight()) * lineSize);
+	ThreadPool::instance().parallelFor(0, getHeight(), [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			const auto source = begin() + i * getWidth();
+			for (auto j = 0; j < lineSize; ++j) {
+				const auto index = getBorderIndex(j - kernel.getWidth() / 2, getWidth(), borderEffect);
+				padded[i * lineSize + j] = index < 0 ? 0 : source[index];
+			}
+		}
+	});
+	ThreadPool::instance().parallelFor(0, getHeight(), [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			const auto destination = result.begin() + i * getWidth();
 			for (auto u = 0; u < kernel.getHeight(); ++u) {
+				const auto index = getBorderIndex(i + u - kernel.getHeight() / 2, getHeight(), borderEffect);
+				if (index < 0) {
+					continue;
+				}
+				const auto line = &padded[index * lineSize];
 				for (auto v = 0; v < kernel.getWidth(); ++v) {
-					value += getValue(i + u - kernel.getHeight() / 2,
-						j + v - kernel.getWidth() / 2,
-						borderEffect) *
-						kernel.get(u, v);
+					SimdKernels::axpy(destination, line + v, kernel.get(u, v), getWidth());
 				}
 			}
-			result.set(i, j, value);
 		}
+	});
+	return result;
+}
+
+int Image::getBorderIndex(const int index, const int size, const BorderEffectType borderEffect) {
+	if (index >= 0 && index < size) {
+		return index;
 	}
+	if (size == 0) {
+		return -1;
+	}
+	switch (borderEffect) {
+	case BorderEffectType::COPY:
+		return std::max(0, std::min(size - 1, index));
+	case BorderEffectType::REFLECT:
+		return index >= size ? 2 * (size - 1) - index : abs(index);
+	case BorderEffectType::CYCLICAL:
+		return (index + size) % size;
+	default:
+		return -1;
+	}
+}
+
+void Image::fillLine(const ImageView &source, const int row, const int shift, const BorderEffectType borderEffect, float *line, const int lineSize) {
+	const auto sourceRow = source.getRow(row);
+	const auto interiorBegin = std::min(shift, lineSize);
+	const auto interiorEnd = std::min(lineSize, shift + source.getWidth());
+	for (auto j = 0; j < interiorBegin; ++j) {
+		const auto index = getBorderIndex(j - shift, source.getWidth(), borderEffect);
+		line[j] = index < 0 ? 0 : sourceRow[index];
+	}
+	std::copy(sourceRow, sourceRow + (interiorEnd - interiorBegin), line + interiorBegin);
+	for (auto j = interiorEnd; j < lineSize; ++j) {
+		const auto index = getBorderIndex(j - shift, source.getWidth(), borderEffect);
+		line[j] = index < 0 ? 0 : sourceRow[index];
+	}
+}
+
+void Image::convRow(const ImageView &source, const Image &kernel, const BorderEffectType borderEffect, float *destination) {
+	Q_ASSERT(kernel.getHeight() == 1);
+	const auto kernelSize = kernel.getWidth();
+	const auto kernelData = kernel.begin();
+	const auto shift = kernelSize / 2;
+	const auto width = source.getWidth();
+	ThreadPool::instance().parallelFor(0, source.getHeight(), [&](const int rowBegin, const int rowEnd) {
+		auto line = std::vector<float>(width + kernelSize - 1);
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			fillLine(source, i, shift, borderEffect, line.data(), int(line.size()));
+			SimdKernels::convolveLine(destination + i * width, line.data(), kernelData, kernelSize, width);
+		}
+	});
+}
+
+void Image::convColumn(const ImageView &source, const Image &kernel, const BorderEffectType borderEffect, float *destination) {
+	Q_ASSERT(kernel.getWidth() == 1);
+	const auto kernelSize = kernel.getHeight();
+	const auto kernelData = kernel.begin();
+	const auto shift = kernelSize / 2;
+	const auto width = source.getWidth();
+	ThreadPool::instance().parallelFor(0, source.getHeight(), [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			auto destinationRow = destination + i * width;
+			std::fill(destinationRow, destinationRow + width, 0.f);
+			for (auto u = 0; u < kernelSize; ++u) {
+				const auto index = getBorderIndex(i + u - shift, source.getHeight(), borderEffect);
+				if (index < 0) {
+					continue;
+				}
+				SimdKernels::axpy(destinationRow, source.getRow(index), kernelData[u], width);
+			}
+		}
+	});
+}
+
+void Image::convSeparable(const ImageView &source, const Image &rowKernel, const Image &columnKernel, const BorderEffectType borderEffect, float *destination) {
+	auto rowPass = createUninitialized(source.getHeight(), source.getWidth());
+	convRow(source, rowKernel, borderEffect, rowPass.begin());
+	convColumn(rowPass.getView(), columnKernel, borderEffect, destination);
+}
+
+Image Image::convSeparable(const Image &rowKernel, const Image &columnKernel, const BorderEffectType borderEffect) const {
+	auto result = createUninitialized(getHeight(), getWidth());
+	convSeparable(getView(), rowKernel, columnKernel, borderEffect, result.begin());
 	return result;
 }
 
 Image Image::sobelX(const BorderEffectType borderEffect) const {
-	return conv(KernelsFactory::sobelGradientXKernel(), borderEffect);
+	return convSeparable(KernelsFactory::sobelDerivativeKernel(GaussKernelType::ROW),
+		KernelsFactory::sobelSmoothingKernel(GaussKernelType::COLUMN),
+		borderEffect);
 }
 
 Image Image::sobelY(const BorderEffectType borderEffect) const {
-	return conv(KernelsFactory::sobelGradientYKernel(), borderEffect);
+	return convSeparable(KernelsFactory::sobelSmoothingKernel(GaussKernelType::ROW),
+		KernelsFactory::sobelDerivativeKernel(GaussKernelType::COLUMN),
+		borderEffect);
 }
 
 Image Image::sobel(const BorderEffectType borderEffect) const {
+	TRACE_SCOPE_IMAGE("Image::sobel", getHeight(), getWidth());
 	return ImageHelper::hypo(sobelX(borderEffect), sobelY(borderEffect));
 }
 
+int Image::getGaussRadius(const double sigma, const int height, const int width) {
+	const auto r = int((sigma + 0.5) * 3);
+	const auto maxR = std::min(height, width) / 2;
+	return std::max(std::min(r, maxR), 1);
+}
+
 Image Image::gauss(const double sigma, const BorderEffectType borderEffect) const {
-	auto r = int((sigma + 0.5) * 3);
-	const auto maxR = std::min(getHeight(), getWidth()) / 2;
-	r = std::max(std::min(r, maxR), 1);
-	return conv(KernelsFactory::gaussKernel(r, GaussKernelType::ROW), borderEffect)
-		.conv(KernelsFactory::gaussKernel(r, GaussKernelType::COLUMN), borderEffect);
+	TRACE_SCOPE_IMAGE("Image::gauss", getHeight(), getWidth());
+	auto result = createUninitialized(getHeight(), getWidth());
+	gaussInto(getView(), sigma, borderEffect, result.begin());
+	return result;
+}
+
+void Image::gaussInto(const ImageView &source, const double sigma, const BorderEffectType borderEffect, float *destination) {
+	const auto r = getGaussRadius(sigma, source.getHeight(), source.getWidth());
+	convSeparable(source,
+		KernelsFactory::gaussKernel(r, GaussKernelType::ROW),
+		KernelsFactory::gaussKernel(r, GaussKernelType::COLUMN),
+		borderEffect,
+		destination);
 }
 
 void Image::resize(const int height, const int width)
 {
 	if (height * width > getDataSize()) {
-		_dataSize = height * width;
-		_data = std::make_unique<double[]>(getDataSize());
+		_data = BufferPool::instance().allocate(size_t(height) * width);
 	}
 	this->_height = height;
 	this->_width = width;
@@ -156,6 +372,9 @@ void Image::resize(const int height, const int width)
 
 Image Image::getResized(const int height, const int width) const
 {
+	if (height * width > getHeight() * getWidth()) {
+		return Image(height, width);
+	}
 	auto result = getCopy();
 	result.resize(height, width);
 	return result;
@@ -163,109 +382,252 @@ Image Image::getResized(const int height, const int width) const
 
 Image Image::downSample() const
 {
-	auto result = getResized(getHeight() / 2, getWidth() / 2);
-	for (auto i = 0; i < result.getHeight(); ++i) {
-		for (auto j = 0; j < result.getWidth(); ++j) {
-			result.set(i, j, 
-				(get(i * 2, j * 2) + get(i * 2 + 1, j * 2) + get(i * 2, j * 2 + 1) + get(i * 2 + 1, j * 2 + 1)) / 4);
+	auto result = createUninitialized(getHeight() / 2, getWidth() / 2);
+	downSampleInto(getView(), result.begin());
+	return result;
+}
+
+void Image::downSampleInto(const ImageView &source, float *destination)
+{
+	const auto height = source.getHeight() / 2;
+	const auto width = source.getWidth() / 2;
+	ThreadPool::instance().parallelFor(0, height, [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			const auto top = source.getRow(i * 2);
+			const auto bottom = source.getRow(i * 2 + 1);
+			auto destinationRow = destination + i * width;
+			for (auto j = 0; j < width; ++j) {
+				destinationRow[j] = (top[j * 2] + bottom[j * 2] + top[j * 2 + 1] + bottom[j * 2 + 1]) / 4;
+			}
 		}
+	});
+}
+
+void Image::gaussDownSampleInto(const ImageView &source, const double sigma, const BorderEffectType borderEffect, float *destination)
+{
+	const auto r = getGaussRadius(sigma, source.getHeight(), source.getWidth());
+	const auto &rowKernel = KernelsFactory::gaussKernel(r, GaussKernelType::ROW);
+	const auto &columnKernel = KernelsFactory::gaussKernel(r, GaussKernelType::COLUMN);
+	auto rowPass = createUninitialized(source.getHeight(), source.getWidth());
+	convRow(source, rowKernel, borderEffect, rowPass.begin());
+	const auto sourceHeight = source.getHeight();
+	const auto sourceWidth = source.getWidth();
+	const auto height = sourceHeight / 2;
+	const auto width = sourceWidth / 2;
+	const auto kernelSize = columnKernel.getHeight();
+	const auto shift = kernelSize / 2;
+	ThreadPool::instance().parallelFor(0, height, [&](const int rowBegin, const int rowEnd) {
+		auto blurred = std::vector<float>(2 * size_t(sourceWidth));
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			std::fill(blurred.begin(), blurred.end(), 0.f);
+			for (auto p = 0; p < 2; ++p) {
+				const auto line = blurred.data() + p * sourceWidth;
+				for (auto u = 0; u < kernelSize; ++u) {
+					const auto index = getBorderIndex(i * 2 + p + u - shift, sourceHeight, borderEffect);
+					if (index < 0) {
+						continue;
+					}
+					SimdKernels::axpy(line, rowPass.begin() + index * sourceWidth, columnKernel.begin()[u], sourceWidth);
+				}
+			}
+			const auto top = blurred.data();
+			const auto bottom = blurred.data() + sourceWidth;
+			auto destinationRow = destination + i * width;
+			for (auto j = 0; j < width; ++j) {
+				destinationRow[j] = (top[j * 2] + bottom[j * 2] + top[j * 2 + 1] + bottom[j * 2 + 1]) / 4;
+			}
+		}
+	});
+}
+
+Image& Image::operator=(const Image &image) {
+	if (this != &image) {
+		resize(image.getHeight(), image.getWidth());
+		std::copy(image.begin(), image.end(), begin());
 	}
-	return result;
+	return *this;
 }
 
-Image& Image::operator=(const Image &Image) {
-	_height = Image._height;
-	_width = Image._width;
-	_dataSize = getHeight() * getWidth();
-	_data = std::make_unique<double[]>(size_t(getDataSize()));
-	for (auto i = 0; i < getDataSize(); ++i) {
-		_data[i] = Image._data[i];
+Image& Image::operator=(Image &&image) {
+	if (this != &image) {
+		_height = image._height;
+		_width = image._width;
+		_data = std::move(image._data);
+		image._height = 0;
+		image._width = 0;
 	}
 	return *this;
 }
 
 Image Image::moravec(const int shift, const BorderEffectType borderEffect) const {
-	auto result = Image(getHeight(), getWidth());
-	for (auto i = 0; i < getHeight(); ++i) {
-		for (auto j = 0; j < getWidth(); ++j) {
-			auto minValue = std::numeric_limits<double>::max();
-			for (auto u = -1; u <= 1; ++u) {
-				for (auto v = -1; v <= 1; ++v) {
-					if (u == 0 && v == 0) {
+	TRACE_SCOPE_IMAGE("Image::moravec", getHeight(), getWidth());
+	auto result = createUninitialized(getHeight(), getWidth());
+	const auto response = MoravecHelper::getResponse<double>(*this, shift, borderEffect);
+	std::copy(response.begin(), response.end(), result.begin());
+	return result;
+}
+
+Image Image::harris(const double &sigma, const BorderEffectType borderEffect, const HarrisMode mode) const {
+	TRACE_SCOPE_IMAGE("Image::harris", getHeight(), getWidth());
+	return mode == HarrisMode::FUSED
+		? harrisFused(sigma, borderEffect)
+		: harrisBasic(sigma, borderEffect);
+}
+
+Image Image::harrisBasic(const double sigma, const BorderEffectType borderEffect) const {
+	auto result = createUninitialized(getHeight(), getWidth());
+	const auto gradX = sobelX(borderEffect);
+	const auto gradY = sobelY(borderEffect);
+	const auto A = gauss(gradX * gradX, sigma, borderEffect);
+	const auto B = gauss(gradX * gradY, sigma, borderEffect);
+	const auto C = gauss(gradY * gradY, sigma, borderEffect);
+	ThreadPool::instance().parallelFor(0, getHeight(), [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			for (auto j = 0; j < getWidth(); ++j) {
+				const auto a = double(A.get(i, j));
+				const auto b = double(B.get(i, j));
+				const auto c = double(C.get(i, j));
+				const auto d = sqrt((a - c) * (a - c) + 4 * b * b);
+				result.set(i, j, std::min(fabs((a + c - d) / 2), fabs((a + c + d) / 2)));
+			}
+		}
+	});
+	return result;
+}
+
+Image Image::harrisFused(const double sigma, const BorderEffectType borderEffect) const {
+	auto result = createUninitialized(getHeight(), getWidth());
+	if (getHeight() == 0 || getWidth() == 0) {
+		return result;
+	}
+	const auto r = getGaussRadius(sigma, getHeight(), getWidth());
+	const auto &gaussRow = KernelsFactory::gaussKernel(r, GaussKernelType::ROW);
+	const auto &gaussColumn = KernelsFactory::gaussKernel(r, GaussKernelType::COLUMN);
+	const auto &smoothing = KernelsFactory::sobelSmoothingKernel(GaussKernelType::ROW);
+	const auto &derivative = KernelsFactory::sobelDerivativeKernel(GaussKernelType::ROW);
+	const auto gaussSize = gaussRow.getWidth();
+	const auto width = getWidth();
+	const auto tilesCount = (getHeight() + HARRIS_TILE_HEIGHT - 1) / HARRIS_TILE_HEIGHT;
+	ThreadPool::instance().parallelFor(0, tilesCount, [&](const int tileBegin, const int tileEnd) {
+		const auto tensorRowsCount = HARRIS_TILE_HEIGHT + gaussSize - 1;
+		auto line = std::vector<float>(width + std::max(gaussSize, 3) - 1);
+		auto derivativeLine = std::vector<float>(width);
+		auto smoothingLine = std::vector<float>(width);
+		auto gradX = std::vector<float>(width);
+		auto gradY = std::vector<float>(width);
+		auto product = std::vector<float>(width);
+		auto tensor = std::vector<float>(size_t(3) * tensorRowsCount * width);
+		auto tensorRowValid = std::vector<bool>(tensorRowsCount);
+		auto window = std::vector<float>(size_t(3) * width);
+		for (auto tile = tileBegin; tile < tileEnd; ++tile) {
+			const auto rowBegin = tile * HARRIS_TILE_HEIGHT;
+			const auto rowEnd = std::min(getHeight(), rowBegin + HARRIS_TILE_HEIGHT);
+			const auto rowsCount = rowEnd - rowBegin + gaussSize - 1;
+			for (auto q = 0; q < rowsCount; ++q) {
+				const auto m = getBorderIndex(rowBegin + q - gaussSize / 2, getHeight(), borderEffect);
+				tensorRowValid[q] = m >= 0;
+				if (m < 0) {
+					continue;
+				}
+				std::fill(gradX.begin(), gradX.end(), 0.f);
+				std::fill(gradY.begin(), gradY.end(), 0.f);
+				for (auto u = 0; u < 3; ++u) {
+					const auto index = getBorderIndex(m + u - 1, getHeight(), borderEffect);
+					if (index < 0) {
 						continue;
 					}
-					auto value = .0;
-					for (auto a = -shift; a <= shift; ++a) {
-						for (auto b = -shift; b <= shift; ++b) {
-							value +=
-								pow(getValue(i + u + a, j + v + b, borderEffect) - getValue(i + a, j + b, borderEffect), 2);
+					fillLine(getView(), index, 1, borderEffect, line.data(), width + 2);
+					SimdKernels::convolveLine(derivativeLine.data(), line.data(), derivative.getData(), 3, width);
+					SimdKernels::convolveLine(smoothingLine.data(), line.data(), smoothing.getData(), 3, width);
+					SimdKernels::axpy(gradX.data(), derivativeLine.data(), smoothing.get(0, u), width);
+					SimdKernels::axpy(gradY.data(), smoothingLine.data(), derivative.get(0, u), width);
+				}
+				const float *factors[3][2] = { { gradX.data(), gradX.data() }, { gradX.data(), gradY.data() }, { gradY.data(), gradY.data() } };
+				for (auto channel = 0; channel < 3; ++channel) {
+					SimdKernels::multiply(product.data(), factors[channel][0], factors[channel][1], width);
+					for (auto j = 0; j < width + gaussSize - 1; ++j) {
+						const auto index = getBorderIndex(j - gaussSize / 2, width, borderEffect);
+						line[j] = index < 0 ? 0 : product[index];
+					}
+					SimdKernels::convolveLine(&tensor[(size_t(channel) * tensorRowsCount + q) * width], line.data(), gaussRow.getData(), gaussSize, width);
+				}
+			}
+			for (auto i = rowBegin; i < rowEnd; ++i) {
+				std::fill(window.begin(), window.end(), 0.f);
+				for (auto channel = 0; channel < 3; ++channel) {
+					for (auto u = 0; u < gaussSize; ++u) {
+						const auto q = i - rowBegin + u;
+						if (!tensorRowValid[q]) {
+							continue;
 						}
+						SimdKernels::axpy(&window[size_t(channel) * width], &tensor[(size_t(channel) * tensorRowsCount + q) * width], gaussColumn.get(u, 0), width);
 					}
-					minValue = std::min(minValue, value);
+				}
+				for (auto j = 0; j < width; ++j) {
+					const auto a = double(window[j]);
+					const auto b = double(window[width + j]);
+					const auto c = double(window[2 * width + j]);
+					const auto d = sqrt((a - c) * (a - c) + 4 * b * b);
+					result.set(i, j, std::min(fabs((a + c - d) / 2), fabs((a + c + d) / 2)));
 				}
 			}
-			result.set(i, j, minValue);
 		}
-	}
+	});
 	return result;
 }
 
-Image Image::harris(const double &sigma, const BorderEffectType borderEffect) const {
-	auto result = Image(getHeight(), getWidth());
-	const auto gradX = conv(KernelsFactory::sobelGradientXKernel(), borderEffect);
-	const auto gradY = conv(KernelsFactory::sobelGradientYKernel(), borderEffect);
-	const auto A = ImageHelper::scalarMultiply(gradX, gradX).gauss(sigma, borderEffect);
-	const auto B = ImageHelper::scalarMultiply(gradX, gradY).gauss(sigma, borderEffect);
-	const auto C = ImageHelper::scalarMultiply(gradY, gradY).gauss(sigma, borderEffect);
-	for (auto i = 0; i < getHeight(); ++i) {
-		for (auto j = 0; j < getWidth(); ++j) {
-			const auto a = A.get(i, j);
-			const auto b = B.get(i, j);
-			const auto c = C.get(i, j);
-			const auto d = sqrt((a - c) * (a - c) + 4 * b * b);
-			result.set(i, j, std::min(fabs((a + c - d) / 2), fabs((a + c + d) / 2)));
-		}
-	}
-	return result;
+void Image::saveAsImage(QString filename) const {
+	toGrayscaleQImage().save(filename);
 }
 
-void Image::saveAsImage(QString filename) const {
-	toQImage().save(filename);
+bool Image::saveAsRaw(const QString &filename) const {
+	return RawImageFile::write(filename, 1, { RawImageLevel{ 0, 0, getHeight(), getWidth(), 0, 0 } }, { getData() });
 }
 
-Image Image::operator-(const Image &Image) {
-	return ImageHelper::zip(*this, Image, [](auto x, auto y) { return x - y; });
+ImageView Image::mapRaw(const QString &filename) {
+	const auto file = RawImageFile::map(filename);
+	return file.isNull() || file.getLevelsCount() == 0 ? ImageView() : file.getView(0);
 }
 
 std::vector<ImagePoint> Image::getLocalMaximums(const int shift, const double treshold, const BorderEffectType borderType) const {
-	auto result = std::vector<ImagePoint>();
-	for (auto i = 0; i < getHeight(); ++i) {
-		for (auto j = 0; j < getWidth(); ++j) {
-			if (get(i, j) < treshold) {
-				continue;
-			}
-			auto isMaximum = true;
-			for (auto di = -shift; di <= shift; ++di) {
-				for (auto dj = -shift; dj <= shift; ++dj) {
-					if(di ==0 && dj == 0) {
-						continue;
-					}
-					if (getValue(i + di, j + dj, borderType) >= get(i, j)) {
-						isMaximum = false;
+	TRACE_SCOPE_IMAGE("Image::getLocalMaximums", getHeight(), getWidth());
+	const auto padded = PaddedImage<float>(*this, shift, borderType);
+	auto rows = std::vector<std::vector<ImagePoint>>(getHeight());
+	ThreadPool::instance().parallelFor(0, getHeight(), [&](const int rowBegin, const int rowEnd) {
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			for (auto j = 0; j < getWidth(); ++j) {
+				const auto value = get(i, j);
+				if (value < treshold) {
+					continue;
+				}
+				auto isMaximum = true;
+				for (auto di = -shift; di <= shift; ++di) {
+					const auto row = padded.getRow(i + di);
+					for (auto dj = -shift; dj <= shift; ++dj) {
+						if ((di != 0 || dj != 0) && row[j + dj] >= value) {
+							isMaximum = false;
+						}
 					}
 				}
+				if (!isMaximum) {
+					continue;
+				}
+				rows[i].emplace_back(i, j, value);
 			}
-			if(!isMaximum) {
-				continue;
-			}
-			result.emplace_back(i, j, get(i, j));
 		}
+	});
+	auto result = std::vector<ImagePoint>();
+	for (auto &row : rows) {
+		result.insert(result.end(), row.begin(), row.end());
 	}
+	TRACE_SET_POINTS(result.size());
 	return result;
 }
 
 QImage Image::toQImageWithPoints(const std::vector<ImagePoint>& points) const
 {
+	TRACE_SCOPE_IMAGE("Image::toQImageWithPoints", getHeight(), getWidth());
+	TRACE_SET_POINTS(points.size());
 	auto image = toQImage();
 	QPainter painter(&image);
 	auto pen = QPen(Qt::red);
@@ -279,92 +641,17 @@ QImage Image::toQImageWithPoints(const std::vector<ImagePoint>& points) const
 
 std::vector<ImagePoint> Image::nonMaxSuppression(const std::vector<ImagePoint>& points, const int limitCount, const double filterValue) const
 {
-	auto result = std::vector<ImagePoint>(points);
-	auto maxRadius = int(sqrt(pow(getHeight(), 2) + pow(getWidth(), 2)));
-	for (auto r = 0; result.size() > limitCount && r < maxRadius; ++r) {
-		for (auto i = 0; i < result.size() && result.size() > limitCount; ++i) {
-			for (auto j = 0; j < result.size() && result.size() > limitCount; ++j) {
-				if (sqrt(pow(result[i].getX() - result[j].getX(), 2) + pow(result[i].getY() - result[j].getY(), 2)) <= r
-					&& filterValue * result[i].getValue() > result[j].getValue()) {
-					result.erase(result.begin() + j);
-					i--;
-					break;
-				}
-			}
-		}
-	}
+	TRACE_SCOPE_IMAGE("Image::nonMaxSuppression", getHeight(), getWidth());
+	auto result = SuppressionHelper::adaptiveSuppression(points, limitCount, filterValue);
+	TRACE_SET_POINTS(result.size());
 	return result;
 }
 
-std::vector<Descriptor> Image::getDescriptors(const std::vector<ImagePoint>& points, const int gaussKernelRadius, const BorderEffectType borderEffect) const {
-	const auto gradX = conv(KernelsFactory::sobelGradientXKernel(), borderEffect);
-	const auto gradY = conv(KernelsFactory::sobelGradientYKernel(), borderEffect);
-	const auto kernel = KernelsFactory::gaussKernel(gaussKernelRadius, GaussKernelType::FULL);
-	auto descriptors = std::vector<Descriptor>();
-	for (auto point : points) {
-		Descriptor descriptor(point.getX(), point.getY());
-		const auto netStep = int(ceil(kernel.getWidth() / double(descriptor.getSize())));
-		for (auto i = descriptor.getX() - gaussKernelRadius, kernel_i = 0; i < descriptor.getX() + gaussKernelRadius; ++i, ++kernel_i) {
-			for (auto j = descriptor.getY() - gaussKernelRadius, kernel_j = 0; j < descriptor.getY() + gaussKernelRadius; ++j, ++kernel_j) {
-				const auto  dx = gradX.getValue(i, j, borderEffect),
-							dy = gradY.getValue(i, j, borderEffect);
-				const auto gradAngle = ImageHelper::getNormalizedAngle(atan2(dy, dx));
-				const auto gradLength = sqrt(dx * dx + dy * dy) * kernel.get(kernel_i, kernel_j);
-				descriptor.addValueOnAngleWithIndex(kernel_i / netStep, kernel_j / netStep, gradAngle, gradLength);
-			}
-		}
-		descriptor.normalize();
-		descriptors.emplace_back(std::move(descriptor));
-	}
-	return descriptors;
+DescriptorSet Image::getDescriptors(const std::vector<ImagePoint>& points, const int gaussKernelRadius, const BorderEffectType borderEffect) const {
+	return DescriptorHelper::getDescriptors(GradientField(*this, borderEffect, gaussKernelRadius), points, gaussKernelRadius);
 }
 
-std::vector<Descriptor> Image::getDescriptorsRotateInvariant(const std::vector<ImagePoint>& points, const int gaussKernelRadius, const BorderEffectType borderEffect) const
+DescriptorSet Image::getDescriptorsRotateInvariant(const std::vector<ImagePoint>& points, const int gaussKernelRadius, const BorderEffectType borderEffect) const
 {
-	const auto gradX = conv(KernelsFactory::sobelGradientXKernel(), borderEffect);
-	const auto gradY = conv(KernelsFactory::sobelGradientYKernel(), borderEffect);
-	const auto extraGaussKernelRadius = gaussKernelRadius * 2;
-	const auto extraKernel = KernelsFactory::gaussKernel(extraGaussKernelRadius, GaussKernelType::FULL);
-	auto descriptors = std::vector<Descriptor>();
-	for (auto point : points) {
-		auto angles = getPointMaxGradientAngles(point, extraGaussKernelRadius, gradX, gradY, extraKernel, borderEffect);
-		for (auto angle : angles) {
-			Descriptor descriptor(point.getX(), point.getY(), angle);
-			const auto netStep = int(ceil(gaussKernelRadius * 2 / double(descriptor.getSize())));
-			auto cosAngle = cos(angle);
-			auto sinAngle = sin(angle);
-			for (auto i = descriptor.getX() - extraGaussKernelRadius, kernel_i = 0; i < descriptor.getX() + extraGaussKernelRadius; ++i, ++kernel_i)
-				for (auto j = descriptor.getY() - extraGaussKernelRadius, kernel_j = 0; j < descriptor.getY() + extraGaussKernelRadius; ++j, ++kernel_j) {
-					const auto dx = gradX.getValue(i, j, borderEffect);
-					const auto dy = gradY.getValue(i, j, borderEffect);
-					const auto gradAngleToAdd = ImageHelper::getNormalizedAngle(atan2(dy, dx) - angle);
-					const auto gradLength = sqrt(dx * dx + dy * dy) * extraKernel.get(kernel_i, kernel_j);
-					auto windowRotatedX = int(round((i - descriptor.getX()) * cosAngle - (j - descriptor.getY()) * sinAngle));
-					auto windowRotatedY = int(round((i - descriptor.getX()) * sinAngle + (j - descriptor.getY()) * cosAngle));
-					if (windowRotatedX < -extraGaussKernelRadius || windowRotatedX > -1 || windowRotatedY < -extraGaussKernelRadius || windowRotatedY > -1) {
-						continue;
-					}
-					descriptor.addValueOnAngleWithIndex((windowRotatedX + extraGaussKernelRadius) / netStep, (windowRotatedY + extraGaussKernelRadius) / netStep, gradAngleToAdd, gradLength);
-				}
-			descriptor.normalize();
-			descriptors.emplace_back(std::move(descriptor));
-		}
-	}
-	return descriptors;
+	return DescriptorHelper::getDescriptorsRotateInvariant(GradientField(*this, borderEffect, 2 * gaussKernelRadius), points, gaussKernelRadius);
 }
-
-std::vector<double> Image::getPointMaxGradientAngles(const ImagePoint& point, const int gaussKernelRadius, const Image& gradX, const Image& gradY, const Image& gaussKernel, const BorderEffectType borderEffect) const
-{
-	Descriptor largeDescriptor(BIN_ROTATION_IVARIANT_ORIENTATIONS_COUNT);
-	auto angles = std::vector<double>();
-	for (auto i = point.getX() - gaussKernelRadius, kernel_i = 0; i < point.getX() + gaussKernelRadius; ++i, ++kernel_i) {
-		for (auto j = point.getY() - gaussKernelRadius, kernel_j = 0; j < point.getY() + gaussKernelRadius; ++j, ++kernel_j) {
-			const auto dx = gradX.getValue(i, j, borderEffect);
-			const auto dy = gradY.getValue(i, j, borderEffect);
-			const auto angle = ImageHelper::getNormalizedAngle(atan2(dy, dx));
-			const auto gradLength = sqrt(dx * dx + dy * dy) * gaussKernel.get(kernel_i, kernel_j);
-			largeDescriptor.addValueOnAngle(angle, gradLength);
-		}
-	}
-	return largeDescriptor.maxOrientationInterpolatedAngles();
-}
\ No newline at end of file
@@ -7,7 +7,17 @@
 #include <algorithm>
 #include <qglobal.h>
 #include <vector>
+#include <limits>
+#include <mutex>
 #include "Descriptor.h"
+#include "DescriptorSet.h"
+#include "ImageView.h"
+#include "KernelsFactory.h"
+#include "ThreadPool.h"
+#include "BufferPool.h"
+#include "ImageExpression.h"
+#include "SimdKernels.h"
+#include "ConstantValues.h"
 
 class QImage;
 class QString;
@@ -15,39 +25,55 @@ class ScalePyramid;
 
 enum class GrayScaleMod { PAL_NTSC, SRGB_HDTV };
 enum class BorderEffectType { ZERO, COPY, REFLECT, CYCLICAL };
+enum class HarrisMode { BASIC, FUSED };
 
-class Image {
+// Grayscale image with float pixels, normally in [0, 1].
+// An Image is also the leaf of lazy element-wise expressions; see ImageExpression.h.
+class Image : public ImageExpression<Image> {
 	int _height = 0,
-		_width = 0,
-		_dataSize = 0;
+		_width = 0;
 
-	std::unique_ptr<double[]> _data = nullptr;
+	BufferPool::Buffer _data;
 
-	double *begin() const
+	float *begin() const
 	{
-		return &_data[0];
+		return _data.get();
 	}
 
-	double *end() const
+	float *end() const
 	{
-		return &_data[0] + getHeight() * getWidth();
+		return _data.get() + getHeight() * getWidth();
 	}
 
 	void normalize();
 	void resize(const int rowSize, const int columnSize);
-	std::vector<double> getPointMaxGradientAngles(const ImagePoint& point, const int gaussKernelRadius, const Image& gradX, const Image& gradY, const Image& gaussKernel, const BorderEffectType borderEffect = BorderEffectType::COPY) const;
+	static void convRow(const ImageView& source, const Image& kernel, const BorderEffectType borderEffect, float *destination);
+	static void convColumn(const ImageView& source, const Image& kernel, const BorderEffectType borderEffect, float *destination);
+	static void convSeparable(const ImageView& source, const Image& rowKernel, const Image& columnKernel, const BorderEffectType borderEffect, float *destination);
+	static void fillLine(const ImageView& source, const int row, const int shift, const BorderEffectType borderEffect, float *line, const int lineSize);
+	Image harrisBasic(const double sigma, const BorderEffectType borderEffect) const;
+	Image harrisFused(const double sigma, const BorderEffectType borderEffect) const;
 
 public:
+	typedef float PixelType;
+
+	static int getBorderIndex(const int index, const int size, const BorderEffectType borderEffect);
+	static int getGaussRadius(const double sigma, const int height, const int width);
+
 	bool contains(const int &i, const int &j) const {
 		return i >= 0 && i < getHeight() && j >= 0 && j < getWidth();
 	}
 
-	double get(const int i, const int j) const {
+	float operator[](const size_t index) const {
+		return _data[index];
+	}
+
+	float get(const int i, const int j) const {
 		Q_ASSERT(contains(i, j));
 		return _data[i * getWidth() + j];
 	}
 
-	void set(const int i, const int j, const double value) const
+	void set(const int i, const int j, const float value) const
 	{
 		Q_ASSERT(contains(i, j));
 		_data[i * getWidth() + j] = value;
@@ -64,53 +90,169 @@ public:
 			delegate(i, _data[i]);
 	}
 
-	ScalePyramid Image::buildScalePyramid(const int scalesPerOctave, const double baseSigma, const double sigma) const
+	ScalePyramid buildScalePyramid(const int scalesPerOctave, const double baseSigma, const double sigma) const
 	{
 		return ScalePyramid::build(*this, scalesPerOctave, baseSigma, sigma);
 	}
 
+	ScalePyramid buildLazyScalePyramid(const int scalesPerOctave, const double baseSigma, const double sigma, const int maxCachedScales = 0) const
+	{
+		return ScalePyramid::buildLazy(*this, scalesPerOctave, baseSigma, sigma, maxCachedScales);
+	}
+
 	Image();
 	Image(const int height, const int width);
-	Image(const int height, const int width, const double *data);
+	// For results whose every pixel is written before it is read.
+	static Image createUninitialized(const int height, const int width);
+	Image(const int height, const int width, const float *data);
 	Image(const Image &matrix);
-	Image(Image &&matrix) = default;
+	Image(Image &&matrix);
+	explicit Image(const ImageView &view);
+	template<typename E>
+	Image(const ImageExpression<E> &expression);
 
 	int getHeight() const { return _height; }
 	int getWidth() const { return _width; }
-	int getDataSize() const { return _dataSize; }
-	int getDataValue(const int i) const { return _data[i]; }
-	double getValue(int i, int j, BorderEffectType typeBorder = BorderEffectType::COPY) const;
+	int getDataSize() const { return int(_data.get_deleter().getCapacity()); }
+	float getDataValue(const int i) const { return _data[i]; }
+	const float *getData() const { return _data.get(); }
+	float *getData() { return _data.get(); }
+	float getValue(int i, int j, BorderEffectType typeBorder = BorderEffectType::COPY) const;
+	ImageView getView() const { return ImageView(_data.get(), _height, _width); }
 
 	Image getCopy() const;
 	Image getNormalized() const;
+	// Evaluates expression and finds its range in the same pass.
+	template<typename E>
+	static Image getNormalized(const ImageExpression<E> &expression);
 	Image getResized(const int height, const int width) const;
 
 	Image conv(const Image& kernel, const BorderEffectType typeBorder = BorderEffectType::COPY) const;
+	Image convSeparable(const Image& rowKernel, const Image& columnKernel, const BorderEffectType typeBorder = BorderEffectType::COPY) const;
 
 	Image &operator=(const Image &matrix);
-	Image operator-(const Image &matrix);
+	Image &operator=(Image &&matrix);
+	template<typename E>
+	Image &operator=(const ImageExpression<E> &expression);
 
 	static Image fromQImage(const QImage &image, const GrayScaleMod &grayScaleMod = GrayScaleMod::SRGB_HDTV);
+	// Reuses the storage of result when it is large enough; a null image gives 0x0.
+	static void fromQImageInto(const QImage &image, const GrayScaleMod &grayScaleMod, Image &result);
 	QImage toQImage() const;
+	// 8-bit output without the RGB32 copy; saveAsImage writes this one.
+	QImage toGrayscaleQImage() const;
 	QImage toQImageWithPoints(const std::vector<ImagePoint>& points) const;
 	void saveAsImage(QString filename) const;
+	// Exact float dump that mapRaw maps back without decoding; see RawImageFile.
+	bool saveAsRaw(const QString &filename) const;
+	static ImageView mapRaw(const QString &filename);
 
+	// Float-only operators. sobelX/sobelY and moravec also have uint8 -> int16/int32
+	// variants in IntegerImageHelper.
 	Image sobelX(const BorderEffectType borderEffect = BorderEffectType::COPY) const;
 	Image sobelY(const BorderEffectType borderEffect = BorderEffectType::COPY) const;
 	Image sobel(const BorderEffectType borderEffect = BorderEffectType::COPY) const;
 	
 	Image gauss(const double sigma, const BorderEffectType borderEffect = BorderEffectType::COPY) const;
+	// Same result as Image(expression).gauss(...), but the row pass evaluates
+	// expression line by line instead of reading a materialized image.
+	template<typename E>
+	static Image gauss(const ImageExpression<E> &expression, const double sigma, const BorderEffectType borderEffect = BorderEffectType::COPY);
 	
 	Image moravec(const int shift, const BorderEffectType borderEffect = BorderEffectType::COPY) const;
-	Image harris(const double &sigma, const BorderEffectType borderEffect = BorderEffectType::COPY) const;
+	// BASIC is the reference; FUSED computes the same response in one tiled pass and is opt-in.
+	Image harris(const double &sigma, const BorderEffectType borderEffect = BorderEffectType::COPY, const HarrisMode mode = HarrisMode::BASIC) const;
 
 	Image downSample() const;
 
+	// Write into caller-owned storage of source.getHeight() * source.getWidth()
+	// (downsampling: (height / 2) * (width / 2)) floats, e.g. a pyramid arena.
+	// gaussDownSampleInto equals gauss followed by downSample without storing
+	// the full-size blurred image.
+	static void gaussInto(const ImageView &source, const double sigma, const BorderEffectType borderEffect, float *destination);
+	static void downSampleInto(const ImageView &source, float *destination);
+	static void gaussDownSampleInto(const ImageView &source, const double sigma, const BorderEffectType borderEffect, float *destination);
+
 	std::vector<ImagePoint> getLocalMaximums(const int shift, const double treshold, const BorderEffectType border = BorderEffectType::COPY) const;
 	std::vector<ImagePoint> nonMaxSuppression(const std::vector<ImagePoint>& points, const int limitCount, const double filterValue) const;
 
-	std::vector<Descriptor> getDescriptors(const std::vector<ImagePoint>& points, const int gaussKernelRadius, const BorderEffectType borderEffect = BorderEffectType::COPY) const;
-	std::vector<Descriptor> getDescriptorsRotateInvariant(const std::vector<ImagePoint> &points, const int gaussKernelRadius, const BorderEffectType borderEffect = BorderEffectType::COPY) const;
+	DescriptorSet getDescriptors(const std::vector<ImagePoint>& points, const int gaussKernelRadius, const BorderEffectType borderEffect = BorderEffectType::COPY) const;
+	DescriptorSet getDescriptorsRotateInvariant(const std::vector<ImagePoint> &points, const int gaussKernelRadius, const BorderEffectType borderEffect = BorderEffectType::COPY) const;
 };
 
+template<typename E>
+Image::Image(const ImageExpression<E> &expression) {
+	*this = expression;
+}
+
+template<typename E>
+Image &Image::operator=(const ImageExpression<E> &expression) {
+	const auto &source = expression.derived();
+	const auto width = source.getWidth();
+	resize(source.getHeight(), width);
+	const auto destination = begin();
+	ThreadPool::instance().parallelFor(0, getHeight(), [&](const int rowBegin, const int rowEnd) {
+		for (auto k = size_t(rowBegin) * width; k < size_t(rowEnd) * width; ++k) {
+			destination[k] = source[k];
+		}
+	});
+	return *this;
+}
+
+template<typename E>
+Image Image::getNormalized(const ImageExpression<E> &expression) {
+	const auto &source = expression.derived();
+	const auto width = source.getWidth();
+	auto result = createUninitialized(source.getHeight(), width);
+	const auto destination = result.begin();
+	auto minValue = std::numeric_limits<float>::max(), maxValue = std::numeric_limits<float>::lowest();
+	std::mutex mutex;
+	ThreadPool::instance().parallelFor(0, result.getHeight(), [&](const int rowBegin, const int rowEnd) {
+		auto bandMin = std::numeric_limits<float>::max(), bandMax = std::numeric_limits<float>::lowest();
+		for (auto k = size_t(rowBegin) * width; k < size_t(rowEnd) * width; ++k) {
+			const auto value = source[k];
+			destination[k] = value;
+			bandMin = std::min(bandMin, value);
+			bandMax = std::max(bandMax, value);
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		minValue = std::min(minValue, bandMin);
+		maxValue = std::max(maxValue, bandMax);
+	});
+	if (result.getHeight() * width == 0) {
+		return result;
+	}
+	auto range = maxValue - minValue;
+	range = range == 0 ? 1 : range;
+	SimdKernels::normalize(destination, result.getHeight() * width, minValue, range);
+	return result;
+}
+
+template<typename E>
+Image Image::gauss(const ImageExpression<E> &expression, const double sigma, const BorderEffectType borderEffect) {
+	const auto &source = expression.derived();
+	const auto height = source.getHeight();
+	const auto width = source.getWidth();
+	const auto r = getGaussRadius(sigma, height, width);
+	const auto &rowKernel = KernelsFactory::gaussKernel(r, GaussKernelType::ROW);
+	const auto &columnKernel = KernelsFactory::gaussKernel(r, GaussKernelType::COLUMN);
+	const auto kernelSize = rowKernel.getWidth();
+	auto rowPass = createUninitialized(height, width);
+	ThreadPool::instance().parallelFor(0, height, [&](const int rowBegin, const int rowEnd) {
+		auto values = std::vector<float>(width);
+		auto line = std::vector<float>(width + kernelSize - 1);
+		for (auto i = rowBegin; i < rowEnd; ++i) {
+			const auto offset = size_t(i) * width;
+			for (auto j = 0; j < width; ++j) {
+				values[j] = source[offset + j];
+			}
+			fillLine(ImageView(values.data(), 1, width), 0, kernelSize / 2, borderEffect, line.data(), int(line.size()));
+			SimdKernels::convolveLine(rowPass.begin() + offset, line.data(), rowKernel.begin(), kernelSize, width);
+		}
+	});
+	auto result = createUninitialized(height, width);
+	convColumn(rowPass.getView(), columnKernel, borderEffect, result.begin());
+	return result;
+}
+
 #endif
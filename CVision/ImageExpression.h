@@ -0,0 +1,132 @@
+#ifndef COMPUTERVISION_IMAGEEXPRESSION_H
+#define COMPUTERVISION_IMAGEEXPRESSION_H
+
+#include <cstddef>
+#include <qglobal.h>
+
+class Image;
+
+// Lazy element-wise arithmetic over images. Operators on images and
+// expressions build a tree of small nodes; nothing is computed until the tree
+// is assigned to an Image or handed to an operator that accepts expressions
+// (Image::gauss, Image::getNormalized), which evaluate it in a single pass.
+// Images are held by reference, so an expression must not outlive them: keep
+// results as Image, not auto.
+template<typename Derived>
+class ImageExpression
+{
+public:
+	const Derived &derived() const { return static_cast<const Derived &>(*this); }
+	int getHeight() const { return derived().getHeight(); }
+	int getWidth() const { return derived().getWidth(); }
+	float operator[](const size_t index) const { return derived()[index]; }
+};
+
+template<typename T>
+struct ImageExpressionStorage {
+	typedef const T type;
+};
+
+template<>
+struct ImageExpressionStorage<Image> {
+	typedef const Image &type;
+};
+
+template<typename Op, typename L, typename R>
+class BinaryImageExpression : public ImageExpression<BinaryImageExpression<Op, L, R>>
+{
+	typename ImageExpressionStorage<L>::type _left;
+	typename ImageExpressionStorage<R>::type _right;
+	Op _op;
+
+public:
+	BinaryImageExpression(const L &left, const R &right, const Op op = Op())
+		: _left(left), _right(right), _op(op)
+	{
+		Q_ASSERT(left.getHeight() == right.getHeight() && left.getWidth() == right.getWidth());
+	}
+
+	int getHeight() const { return _left.getHeight(); }
+	int getWidth() const { return _left.getWidth(); }
+	float operator[](const size_t index) const { return _op(_left[index], _right[index]); }
+};
+
+template<typename Op, typename E>
+class UnaryImageExpression : public ImageExpression<UnaryImageExpression<Op, E>>
+{
+	typename ImageExpressionStorage<E>::type _source;
+	Op _op;
+
+public:
+	UnaryImageExpression(const E &source, const Op op = Op())
+		: _source(source), _op(op)
+	{
+	}
+
+	int getHeight() const { return _source.getHeight(); }
+	int getWidth() const { return _source.getWidth(); }
+	float operator[](const size_t index) const { return _op(_source[index]); }
+};
+
+struct AddOp {
+	float operator()(const float a, const float b) const { return a + b; }
+};
+
+struct SubtractOp {
+	float operator()(const float a, const float b) const { return a - b; }
+};
+
+struct MultiplyOp {
+	float operator()(const float a, const float b) const { return a * b; }
+};
+
+struct DivideOp {
+	float operator()(const float a, const float b) const { return a / b; }
+};
+
+template<typename Op>
+struct BindRightOp {
+	float value;
+	float operator()(const float a) const { return Op()(a, value); }
+};
+
+template<typename Op>
+struct BindLeftOp {
+	float value;
+	float operator()(const float b) const { return Op()(value, b); }
+};
+
+#define COMPUTERVISION_IMAGE_EXPRESSION_OPERATOR(symbol, Op) \
+	template<typename L, typename R> \
+	BinaryImageExpression<Op, L, R> operator symbol(const ImageExpression<L> &left, const ImageExpression<R> &right) { \
+		return BinaryImageExpression<Op, L, R>(left.derived(), right.derived()); \
+	} \
+	template<typename E> \
+	UnaryImageExpression<BindRightOp<Op>, E> operator symbol(const ImageExpression<E> &left, const float right) { \
+		return UnaryImageExpression<BindRightOp<Op>, E>(left.derived(), BindRightOp<Op>{ right }); \
+	} \
+	template<typename E> \
+	UnaryImageExpression<BindLeftOp<Op>, E> operator symbol(const float left, const ImageExpression<E> &right) { \
+		return UnaryImageExpression<BindLeftOp<Op>, E>(right.derived(), BindLeftOp<Op>{ left }); \
+	}
+
+COMPUTERVISION_IMAGE_EXPRESSION_OPERATOR(+, AddOp)
+COMPUTERVISION_IMAGE_EXPRESSION_OPERATOR(-, SubtractOp)
+COMPUTERVISION_IMAGE_EXPRESSION_OPERATOR(*, MultiplyOp)
+COMPUTERVISION_IMAGE_EXPRESSION_OPERATOR(/, DivideOp)
+
+#undef COMPUTERVISION_IMAGE_EXPRESSION_OPERATOR
+
+// f is any callable float(float) / float(float, float); it is inlined into the
+// evaluation loop.
+template<typename E, typename Func>
+UnaryImageExpression<Func, E> mapExpression(const ImageExpression<E> &source, Func f) {
+	return UnaryImageExpression<Func, E>(source.derived(), f);
+}
+
+template<typename L, typename R, typename Func>
+BinaryImageExpression<Func, L, R> zipExpression(const ImageExpression<L> &left, const ImageExpression<R> &right, Func f) {
+	return BinaryImageExpression<Func, L, R>(left.derived(), right.derived(), f);
+}
+
+#endif
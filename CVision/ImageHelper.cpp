@@ -1,24 +1,25 @@
 #include "ImageHelper.h"
 #include "ConstantValues.h"
 #include "Image.h"
+#include "SimdKernels.h"
+#include "ThreadPool.h"
 #include <qglobal.h>
 #include <qmath.h>
 
-Image ImageHelper::zip(const Image& a, const Image& b, std::function<double(double, double)> f) {
-	Q_ASSERT(sameSize(a, b));
-	auto result = Image(a.getHeight(), a.getWidth());
-	result.enumerate([=](int i, double& x) { x = f(a.getDataValue(i), b.getDataValue(i)); });
-	return result;
-}
-
 Image ImageHelper::scalarMultiply(const Image& a, const Image& b)
 {
-	return zip(a, b, [](double x, double y) { return x * y; });
+	Q_ASSERT(sameSize(a, b));
+	auto result = Image::createUninitialized(a.getHeight(), a.getWidth());
+	SimdKernels::multiply(result.getData(), a.getData(), b.getData(), a.getHeight() * a.getWidth());
+	return result;
 }
 
 Image ImageHelper::sqrSum(const Image& a, const Image& b)
 {
-	return zip(a, b, [](double x, double y) { return x * x + y * y; });
+	Q_ASSERT(sameSize(a, b));
+	auto result = Image::createUninitialized(a.getHeight(), a.getWidth());
+	SimdKernels::sqrSum(result.getData(), a.getData(), b.getData(), a.getHeight() * a.getWidth());
+	return result;
 }
 
 bool ImageHelper::sameSize(const Image& a, const Image& b)
@@ -28,22 +29,19 @@ bool ImageHelper::sameSize(const Image& a, const Image& b)
 
 Image ImageHelper::scalarDiv(const Image& img, const double divider)
 {
-	auto result = img.getCopy();
-	result.forEach([=](auto &value) { value /= divider; });
+	auto result = Image::createUninitialized(img.getHeight(), img.getWidth());
+	SimdKernels::divide(result.getData(), img.getData(), divider, img.getHeight() * img.getWidth());
 	return result;
 }
 
 Image ImageHelper::hypo(const Image &a, const Image &b) {
 	Q_ASSERT(sameSize(a, b));
-	const auto height = a.getHeight();
+	auto result = Image::createUninitialized(a.getHeight(), a.getWidth());
 	const auto width = a.getWidth();
-	auto result = Image(height, width);
-	for (auto i = 0; i < height; ++i) {
-		for (auto j = 0; j < width; ++j) {
-			auto value = sqrt(a.get(i, j) * a.get(i, j) + b.get(i, j) * b.get(i, j));
-			result.set(i, j, value);
-		}
-	}
+	ThreadPool::instance().parallelFor(0, a.getHeight(), [&](const int rowBegin, const int rowEnd) {
+		const auto offset = rowBegin * width;
+		SimdKernels::hypo(result.getData() + offset, a.getData() + offset, b.getData() + offset, (rowEnd - rowBegin) * width);
+	});
 	return result;
 }
 
@@ -1,9 +1,8 @@
 #ifndef COMPUTERVISION_IMAGEHELPER_H
 #define COMPUTERVISION_IMAGEHELPER_H
 
-#include <functional>
+#include "Image.h"
 
-class Image;
 class Point;
 class ImagePoint;
 
@@ -17,11 +16,18 @@ public:
 	static bool sameSize(const Image &a, const Image &b);
 	static Image scalarDiv(const Image& img, const double divider);
 	static Image hypo(const Image &a, const Image &b);
-	static Image zip(const Image &a, const Image &b, std::function<double(double, double)> f);
+	template<typename Func>
+	static Image zip(const Image &a, const Image &b, Func f);
 	static double parabolicInterpolation(const double yLeft, const double y, const double yRight) {
 		return -(yRight - yLeft) / (2 * (yLeft + yRight - 2 * y));
 	}
 	static double getInterpolatedAngle(double bin[], const int orientationsCount, const int orientation);
 	static double getNormalizedAngle(const double alpha);
 };
+
+template<typename Func>
+Image ImageHelper::zip(const Image& a, const Image& b, Func f) {
+	Q_ASSERT(sameSize(a, b));
+	return Image(zipExpression(a, b, f));
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,8 @@
+#include "ImageView.h"
+#include "Image.h"
+
+float ImageView::getValue(const int i, const int j, const BorderEffectType borderEffect) const {
+	const auto row = Image::getBorderIndex(i, getHeight(), borderEffect);
+	const auto column = Image::getBorderIndex(j, getWidth(), borderEffect);
+	return row < 0 || column < 0 ? 0 : get(row, column);
+}
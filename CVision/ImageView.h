@@ -0,0 +1,42 @@
+#ifndef COMPUTERVISION_IMAGEVIEW_H
+#define COMPUTERVISION_IMAGEVIEW_H
+
+#include <memory>
+#include <qglobal.h>
+
+enum class BorderEffectType;
+
+// Non-owning read-only view of float pixels laid out like Image.
+// An optional owner keeps the underlying storage alive for as long as the view exists.
+class ImageView {
+	const float *_data = nullptr;
+	int _height = 0,
+		_width = 0;
+	std::shared_ptr<const void> _owner;
+
+public:
+	ImageView() {}
+
+	ImageView(const float *data, const int height, const int width, std::shared_ptr<const void> owner = nullptr)
+		: _data(data), _height(height), _width(width), _owner(std::move(owner))
+	{
+	}
+
+	int getHeight() const { return _height; }
+	int getWidth() const { return _width; }
+	const float *getData() const { return _data; }
+	const float *getRow(const int i) const { return _data + size_t(i) * _width; }
+
+	bool contains(const int i, const int j) const {
+		return i >= 0 && i < getHeight() && j >= 0 && j < getWidth();
+	}
+
+	float get(const int i, const int j) const {
+		Q_ASSERT(contains(i, j));
+		return _data[size_t(i) * _width + j];
+	}
+
+	float getValue(const int i, const int j, const BorderEffectType borderEffect) const;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "IntegerImageHelper.h"
+#include "MoravecHelper.h"
+#include <QImage>
+
+namespace {
+
+const int LUMINANCE_SHIFT = 16;
+
+void getLuminanceWeights(const GrayScaleMod &grayScaleMod, int &red, int &green, int &blue)
+{
+	switch (grayScaleMod)
+	{
+	case GrayScaleMod::PAL_NTSC:
+		red = 19595;
+		green = 38470;
+		blue = 7471;
+		break;
+	default:
+		red = 13959;
+		green = 46858;
+		blue = 4719;
+		break;
+	}
+}
+
+template<typename Kernel>
+ShortImage applyStencil3x3(const ByteImage &image, const BorderEffectType borderEffect, Kernel kernel)
+{
+	auto result = ShortImage(image.getHeight(), image.getWidth());
+	auto columns = std::vector<int>(image.getWidth() + 2);
+	for (auto j = 0; j < int(columns.size()); ++j) {
+		columns[j] = Image::getBorderIndex(j - 1, image.getWidth(), borderEffect);
+	}
+	for (auto i = 0; i < image.getHeight(); ++i) {
+		const uint8_t *rows[3];
+		for (auto u = 0; u < 3; ++u) {
+			const auto index = Image::getBorderIndex(i + u - 1, image.getHeight(), borderEffect);
+			rows[u] = index < 0 ? nullptr : image.getRow(index);
+		}
+		auto destination = result.getRow(i);
+		for (auto j = 0; j < image.getWidth(); ++j) {
+			int window[3][3];
+			for (auto u = 0; u < 3; ++u) {
+				for (auto v = 0; v < 3; ++v) {
+					const auto column = columns[j + v];
+					window[u][v] = rows[u] == nullptr || column < 0 ? 0 : rows[u][column];
+				}
+			}
+			destination[j] = int16_t(kernel(window));
+		}
+	}
+	return result;
+}
+}
+
+ByteImage IntegerImageHelper::fromQImage(const QImage &image, const GrayScaleMod &grayScaleMod)
+{
+	auto result = ByteImage(image.height(), image.width());
+	if (image.format() == QImage::Format_Grayscale8) {
+		for (auto i = 0; i < result.getHeight(); ++i) {
+			std::copy(image.constScanLine(i), image.constScanLine(i) + result.getWidth(), result.getRow(i));
+		}
+		return result;
+	}
+	auto red = 0, green = 0, blue = 0;
+	getLuminanceWeights(grayScaleMod, red, green, blue);
+	const auto source = image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32
+		? image
+		: image.convertToFormat(QImage::Format_RGB32);
+	for (auto i = 0; i < result.getHeight(); ++i) {
+		const auto line = reinterpret_cast<const QRgb *>(source.constScanLine(i));
+		auto destination = result.getRow(i);
+		for (auto j = 0; j < result.getWidth(); ++j) {
+			destination[j] = uint8_t((red * qRed(line[j]) + green * qGreen(line[j]) + blue * qBlue(line[j])
+				+ (1 << (LUMINANCE_SHIFT - 1))) >> LUMINANCE_SHIFT);
+		}
+	}
+	return result;
+}
+
+Image IntegerImageHelper::toImage(const ByteImage &image)
+{
+	return toImage(image, 1.f / 255);
+}
+
+ShortImage IntegerImageHelper::sobelX(const ByteImage &image, const BorderEffectType borderEffect)
+{
+	return applyStencil3x3(image, borderEffect, [](const int(&w)[3][3]) {
+		return (w[0][2] - w[0][0]) + 2 * (w[1][2] - w[1][0]) + (w[2][2] - w[2][0]);
+	});
+}
+
+ShortImage IntegerImageHelper::sobelY(const ByteImage &image, const BorderEffectType borderEffect)
+{
+	return applyStencil3x3(image, borderEffect, [](const int(&w)[3][3]) {
+		return (w[2][0] - w[0][0]) + 2 * (w[2][1] - w[0][1]) + (w[2][2] - w[0][2]);
+	});
+}
+
+IntImage IntegerImageHelper::moravec(const ByteImage &image, const int shift, const BorderEffectType borderEffect)
+{
+	auto result = IntImage(image.getHeight(), image.getWidth());
+	const auto response = MoravecHelper::getResponse<int64_t>(image, shift, borderEffect);
+	std::transform(response.begin(), response.end(), result.getData(), [](const int64_t value) {
+		return int32_t(std::min<int64_t>(value, std::numeric_limits<int32_t>::max()));
+	});
+	return result;
+}
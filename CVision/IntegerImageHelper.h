@@ -0,0 +1,32 @@
+#ifndef COMPUTERVISION_INTEGERIMAGEHELPER_H
+#define COMPUTERVISION_INTEGERIMAGEHELPER_H
+
+#include "TypedImage.h"
+
+class QImage;
+
+// Integer pipeline: ByteImage (uint8) sources for loading, Sobel and Moravec.
+// Gaussian, Harris and descriptors stay on the float Image.
+class IntegerImageHelper
+{
+public:
+	static ByteImage fromQImage(const QImage &image, const GrayScaleMod &grayScaleMod = GrayScaleMod::SRGB_HDTV);
+	static Image toImage(const ByteImage &image);
+	template<typename T>
+	static Image toImage(const TypedImage<T> &image, const float scale);
+
+	static ShortImage sobelX(const ByteImage &image, const BorderEffectType borderEffect = BorderEffectType::COPY);
+	static ShortImage sobelY(const ByteImage &image, const BorderEffectType borderEffect = BorderEffectType::COPY);
+	static IntImage moravec(const ByteImage &image, const int shift, const BorderEffectType borderEffect = BorderEffectType::COPY);
+};
+
+template<typename T>
+Image IntegerImageHelper::toImage(const TypedImage<T> &image, const float scale)
+{
+	auto result = Image::createUninitialized(image.getHeight(), image.getWidth());
+	const auto source = image.getData();
+	result.enumerate([=](int i, float &x) { x = source[i] * scale; });
+	return result;
+}
+
+#endif
@@ -3,28 +3,64 @@
 #include "Image.h"
 #include <qmath.h>
 
-const std::unique_ptr<double[]> KernelsFactory::_sobelGradXData =
-std::unique_ptr<double[]>(
-	new double[9]{
-		-1, 0, 1,
-		-2, 0, 2,
-		-1, 0, 1 });
+std::map<std::pair<int, GaussKernelType>, std::unique_ptr<const Image>> KernelsFactory::_gaussKernels;
+std::mutex KernelsFactory::_gaussKernelsMutex;
 
-const std::unique_ptr<double[]> KernelsFactory::_sobelGradYData =
-std::unique_ptr<double[]>(new double[9]{
-		-1, -2, -1,
-		0, 0, 0,
-		1, 2, 1 });
+namespace {
+const float SOBEL_SMOOTHING_DATA[3] = { 1, 2, 1 };
+const float SOBEL_DERIVATIVE_DATA[3] = { -1, 0, 1 };
+const float SOBEL_GRADIENT_X_DATA[9] = {
+	-1, 0, 1,
+	-2, 0, 2,
+	-1, 0, 1 };
+const float SOBEL_GRADIENT_Y_DATA[9] = {
+	-1, -2, -1,
+	0, 0, 0,
+	1, 2, 1 };
+}
+
+const Image &KernelsFactory::sobelGradientXKernel() {
+	static const auto kernel = Image(3, 3, SOBEL_GRADIENT_X_DATA);
+	return kernel;
+}
 
-Image KernelsFactory::sobelGradientXKernel() {
-	return Image(3, 3, _sobelGradXData.get());
+const Image &KernelsFactory::sobelGradientYKernel() {
+	static const auto kernel = Image(3, 3, SOBEL_GRADIENT_Y_DATA);
+	return kernel;
 }
 
-Image KernelsFactory::sobelGradientYKernel() {
-	return Image(3, 3, _sobelGradYData.get());
+const Image &KernelsFactory::sobelSmoothingKernel(GaussKernelType kernelType) {
+	static const auto row = orientedKernel(3, SOBEL_SMOOTHING_DATA, GaussKernelType::ROW);
+	static const auto column = orientedKernel(3, SOBEL_SMOOTHING_DATA, GaussKernelType::COLUMN);
+	Q_ASSERT(kernelType != GaussKernelType::FULL);
+	return kernelType == GaussKernelType::ROW ? row : column;
+}
+
+const Image &KernelsFactory::sobelDerivativeKernel(GaussKernelType kernelType) {
+	static const auto row = orientedKernel(3, SOBEL_DERIVATIVE_DATA, GaussKernelType::ROW);
+	static const auto column = orientedKernel(3, SOBEL_DERIVATIVE_DATA, GaussKernelType::COLUMN);
+	Q_ASSERT(kernelType != GaussKernelType::FULL);
+	return kernelType == GaussKernelType::ROW ? row : column;
+}
+
+Image KernelsFactory::orientedKernel(const int size, const float *data, GaussKernelType kernelType) {
+	Q_ASSERT(kernelType != GaussKernelType::FULL);
+	return kernelType == GaussKernelType::ROW
+		? Image(1, size, data)
+		: Image(size, 1, data);
+}
+
+const Image &KernelsFactory::gaussKernel(const int r, GaussKernelType gaussKernelType)
+{
+	std::lock_guard<std::mutex> lock(_gaussKernelsMutex);
+	auto &kernel = _gaussKernels[std::make_pair(r, gaussKernelType)];
+	if (kernel == nullptr) {
+		kernel = std::make_unique<const Image>(buildGaussKernel(r, gaussKernelType));
+	}
+	return *kernel;
 }
 
-Image KernelsFactory::gaussKernel(const int r, GaussKernelType gaussKernelType)
+Image KernelsFactory::buildGaussKernel(const int r, GaussKernelType gaussKernelType)
 {
 	auto size = r * 2;
 	auto sigma = size / 3.;
@@ -2,21 +2,30 @@
 #define COMPUTERVISION_KERNELSFACTORY_H
 
 #include <memory>
+#include <map>
+#include <mutex>
+#include <utility>
 
 class Image;
 
 enum class GaussKernelType { FULL, ROW, COLUMN };
 
+// Kernels are built once and shared: the returned references stay valid for
+// the lifetime of the program. Thread-safe.
 class KernelsFactory {
-	static const std::unique_ptr<double[]> _sobelGradXData;
-	static const std::unique_ptr<double[]> _sobelGradYData;
+	static std::map<std::pair<int, GaussKernelType>, std::unique_ptr<const Image>> _gaussKernels;
+	static std::mutex _gaussKernelsMutex;
+	static Image orientedKernel(const int size, const float *data, GaussKernelType kernelType);
 	static Image gaussKernel(const int size, const double sigma);
 	static Image gaussRow(const int size, const double sigma);
 	static Image gaussColumn(const int size, const double sigma);
+	static Image buildGaussKernel(const int r, GaussKernelType gaussKernelType);
 
 public:
-	static Image sobelGradientXKernel();
-	static Image sobelGradientYKernel();
-	static Image gaussKernel(const int r, GaussKernelType gaussKernelType);
+	static const Image &sobelGradientXKernel();
+	static const Image &sobelGradientYKernel();
+	static const Image &sobelSmoothingKernel(GaussKernelType kernelType);
+	static const Image &sobelDerivativeKernel(GaussKernelType kernelType);
+	static const Image &gaussKernel(const int r, GaussKernelType gaussKernelType);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#ifndef COMPUTERVISION_MORAVECHELPER_H
+#define COMPUTERVISION_MORAVECHELPER_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "Image.h"
+#include "PaddedImage.h"
+#include "ThreadPool.h"
+#include "ConstantValues.h"
+
+// Moravec response with running box sums: every direction keeps a
+// squared-difference row per image row and slides a (2 * shift + 1)^2 window
+// over it, so the cost per pixel does not depend on shift.
+// Non-zero counts are tracked next to the sums so that flat windows give an
+// exact zero even when floating-point sums drift.
+// The image is read through a PaddedImage with a (shift + 1) halo.
+// Works on any image type with get/getHeight/getWidth/PixelType (Image, TypedImage<T>).
+class MoravecHelper
+{
+	template<typename Accumulator, typename PixelType>
+	static void addDirection(const PaddedImage<PixelType> &image, const int shift,
+		const int u, const int v, const int rowBegin, const int rowEnd,
+		std::vector<Accumulator> &rowSums, std::vector<int> &rowCounts,
+		std::vector<Accumulator> &columnSums, std::vector<int> &columnCounts, std::vector<Accumulator> &minimum);
+
+public:
+	template<typename Accumulator, typename ImageType>
+	static std::vector<Accumulator> getResponse(const ImageType &image, const int shift, const BorderEffectType borderEffect);
+};
+
+template<typename Accumulator, typename ImageType>
+std::vector<Accumulator> MoravecHelper::getResponse(const ImageType &image, const int shift, const BorderEffectType borderEffect)
+{
+	const auto height = image.getHeight();
+	const auto width = image.getWidth();
+	if (height == 0 || width == 0) {
+		return std::vector<Accumulator>();
+	}
+	const auto padded = PaddedImage<typename ImageType::PixelType>(image, shift + 1, borderEffect);
+	auto result = std::vector<Accumulator>(size_t(height) * width);
+	const auto tilesCount = (height + MORAVEC_TILE_HEIGHT - 1) / MORAVEC_TILE_HEIGHT;
+	ThreadPool::instance().parallelFor(0, tilesCount, [&](const int tileBegin, const int tileEnd) {
+		auto rowSums = std::vector<Accumulator>(size_t(MORAVEC_TILE_HEIGHT + 2 * shift) * width);
+		auto rowCounts = std::vector<int>(rowSums.size());
+		auto columnSums = std::vector<Accumulator>(width);
+		auto columnCounts = std::vector<int>(width);
+		for (auto tile = tileBegin; tile < tileEnd; ++tile) {
+			const auto rowBegin = tile * MORAVEC_TILE_HEIGHT;
+			const auto rowEnd = std::min(height, rowBegin + MORAVEC_TILE_HEIGHT);
+			auto minimum = std::vector<Accumulator>(size_t(rowEnd - rowBegin) * width, std::numeric_limits<Accumulator>::max());
+			for (auto u = -1; u <= 1; ++u) {
+				for (auto v = -1; v <= 1; ++v) {
+					if (u == 0 && v == 0) {
+						continue;
+					}
+					addDirection<Accumulator>(padded, shift, u, v, rowBegin, rowEnd, rowSums, rowCounts, columnSums, columnCounts, minimum);
+				}
+			}
+			std::copy(minimum.begin(), minimum.end(), result.begin() + size_t(rowBegin) * width);
+		}
+	});
+	return result;
+}
+
+template<typename Accumulator, typename PixelType>
+void MoravecHelper::addDirection(const PaddedImage<PixelType> &image, const int shift,
+	const int u, const int v, const int rowBegin, const int rowEnd,
+	std::vector<Accumulator> &rowSums, std::vector<int> &rowCounts,
+	std::vector<Accumulator> &columnSums, std::vector<int> &columnCounts, std::vector<Accumulator> &minimum)
+{
+	const auto width = image.getWidth();
+	const auto windowSize = 2 * shift + 1;
+	const auto lineSize = width + 2 * shift;
+	auto line = std::vector<Accumulator>(lineSize);
+	const auto rowsCount = rowEnd - rowBegin + 2 * shift;
+	for (auto p = 0; p < rowsCount; ++p) {
+		const auto source = image.getRow(rowBegin + p - shift) - shift;
+		const auto shifted = image.getRow(rowBegin + p - shift + u) - shift + v;
+		for (auto q = 0; q < lineSize; ++q) {
+			const auto difference = shifted[q] - source[q];
+			line[q] = Accumulator(difference) * Accumulator(difference);
+		}
+		auto sums = &rowSums[size_t(p) * width];
+		auto counts = &rowCounts[size_t(p) * width];
+		auto sum = Accumulator(0);
+		auto count = 0;
+		for (auto q = 0; q < windowSize; ++q) {
+			sum += line[q];
+			count += line[q] != 0;
+		}
+		sums[0] = sum;
+		counts[0] = count;
+		for (auto j = 1; j < width; ++j) {
+			sum += line[j + windowSize - 1] - line[j - 1];
+			count += (line[j + windowSize - 1] != 0) - (line[j - 1] != 0);
+			sums[j] = sum;
+			counts[j] = count;
+		}
+	}
+	std::fill(columnSums.begin(), columnSums.end(), Accumulator(0));
+	std::fill(columnCounts.begin(), columnCounts.end(), 0);
+	for (auto p = 0; p < windowSize; ++p) {
+		for (auto j = 0; j < width; ++j) {
+			columnSums[j] += rowSums[size_t(p) * width + j];
+			columnCounts[j] += rowCounts[size_t(p) * width + j];
+		}
+	}
+	for (auto i = 0; i < rowEnd - rowBegin; ++i) {
+		if (i > 0) {
+			const auto added = size_t(i + windowSize - 1) * width;
+			const auto removed = size_t(i - 1) * width;
+			for (auto j = 0; j < width; ++j) {
+				columnSums[j] += rowSums[added + j] - rowSums[removed + j];
+				columnCounts[j] += rowCounts[added + j] - rowCounts[removed + j];
+			}
+		}
+		auto destination = &minimum[size_t(i) * width];
+		for (auto j = 0; j < width; ++j) {
+			const auto value = columnCounts[j] == 0 ? Accumulator(0) : std::max(Accumulator(0), columnSums[j]);
+			destination[j] = std::min(destination[j], value);
+		}
+	}
+}
+
+#endif
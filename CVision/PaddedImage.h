@@ -0,0 +1,123 @@
+#ifndef COMPUTERVISION_PADDEDIMAGE_H
+#define COMPUTERVISION_PADDEDIMAGE_H
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <qglobal.h>
+#include "Image.h"
+
+// Copy of an image surrounded by a halo of the given width, filled once with
+// the border effect, so stencils reaching at most halo pixels outside the
+// image read rows without bounds checks or border switches.
+// Works with any source that has get/getHeight/getWidth (Image, ImageView, TypedImage<T>).
+template<typename T>
+class PaddedImage {
+	int _height = 0,
+		_width = 0,
+		_halo = 0,
+		_stride = 0;
+	BorderEffectType _borderEffect = BorderEffectType::COPY;
+	std::unique_ptr<T[]> _data;
+
+	static int getHaloIndex(int index, const int size, const BorderEffectType borderEffect)
+	{
+		if (size == 0) {
+			return -1;
+		}
+		if (borderEffect == BorderEffectType::ZERO) {
+			return Image::getBorderIndex(index, size, borderEffect);
+		}
+		if (size == 1) {
+			return 0;
+		}
+		while (index < 0 || index >= size) {
+			index = Image::getBorderIndex(index, size, borderEffect);
+		}
+		return index;
+	}
+
+public:
+	PaddedImage() {}
+
+	template<typename ImageType>
+	PaddedImage(const ImageType &source, const int halo, const BorderEffectType borderEffect)
+		: _height(source.getHeight()),
+		_width(source.getWidth()),
+		_halo(halo),
+		_stride(source.getWidth() + 2 * halo),
+		_borderEffect(borderEffect),
+		_data(std::make_unique<T[]>(size_t(source.getHeight() + 2 * halo) * (source.getWidth() + 2 * halo)))
+	{
+		auto columns = std::vector<int>(2 * size_t(halo));
+		for (auto q = 0; q < halo; ++q) {
+			columns[q] = getHaloIndex(q - halo, _width, borderEffect);
+			columns[halo + q] = getHaloIndex(_width + q, _width, borderEffect);
+		}
+		for (auto p = -halo; p < _height + halo; ++p) {
+			const auto row = getHaloIndex(p, _height, borderEffect);
+			auto destination = getRow(p);
+			if (row < 0) {
+				std::fill(destination - halo, destination + _width + halo, T(0));
+				continue;
+			}
+			for (auto q = 0; q < halo; ++q) {
+				destination[q - halo] = columns[q] < 0 ? T(0) : source.get(row, columns[q]);
+				destination[_width + q] = columns[halo + q] < 0 ? T(0) : source.get(row, columns[halo + q]);
+			}
+			for (auto j = 0; j < _width; ++j) {
+				destination[j] = source.get(row, j);
+			}
+		}
+	}
+
+	int getHeight() const { return _height; }
+	int getWidth() const { return _width; }
+	int getHalo() const { return _halo; }
+	BorderEffectType getBorderEffect() const { return _borderEffect; }
+
+	bool containsWindow(const int i, const int j, const int radius) const {
+		return i - radius >= -_halo && i + radius < _height + _halo && j - radius >= -_halo && j + radius < _width + _halo;
+	}
+
+	// Pointer to column 0 of row i; columns [-halo, width + halo) are readable.
+	const T *getRow(const int i) const {
+		Q_ASSERT(i >= -_halo && i < _height + _halo);
+		return _data.get() + size_t(i + _halo) * _stride + _halo;
+	}
+
+	T *getRow(const int i) {
+		Q_ASSERT(i >= -_halo && i < _height + _halo);
+		return _data.get() + size_t(i + _halo) * _stride + _halo;
+	}
+
+	// Columns [j - radius, j + radius) of row i. Read in place when they lie within
+	// the halo, otherwise gathered into buffer through the border effect.
+	const T *getWindowRow(const int i, const int j, const int radius, std::vector<T> &buffer) const {
+		if (i >= -_halo && i < _height + _halo && j - radius >= -_halo && j + radius <= _width + _halo) {
+			return getRow(i) + j - radius;
+		}
+		buffer.resize(2 * size_t(radius));
+		for (auto q = 0; q < 2 * radius; ++q) {
+			buffer[q] = getValue(i, j - radius + q);
+		}
+		return buffer.data();
+	}
+
+	T get(const int i, const int j) const {
+		Q_ASSERT(containsWindow(i, j, 0));
+		return getRow(i)[j];
+	}
+
+	// Like get, but falls back to the border effect beyond the halo.
+	T getValue(const int i, const int j) const {
+		if (containsWindow(i, j, 0)) {
+			return getRow(i)[j];
+		}
+		const auto row = getHaloIndex(i, _height, _borderEffect);
+		const auto column = getHaloIndex(j, _width, _borderEffect);
+		return row < 0 || column < 0 ? T(0) : getRow(row)[column];
+	}
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include "QuantizedDescriptorSet.h"
+#include <cmath>
+#include <algorithm>
+#include "DescriptorSet.h"
+#include "SimdKernels.h"
+
+QuantizedDescriptorSet::QuantizedDescriptorSet(const DescriptorSet &descriptors)
+	: _dimension(descriptors.getDimension()),
+	_stride((_dimension + QUANTIZED_DESCRIPTOR_ROW_ALIGNMENT - 1) / QUANTIZED_DESCRIPTOR_ROW_ALIGNMENT * QUANTIZED_DESCRIPTOR_ROW_ALIGNMENT),
+	_data(size_t(descriptors.getCount()) * _stride, 0),
+	_squaredNorms(descriptors.getCount())
+{
+	for (auto k = 0; k < getCount(); ++k) {
+		const auto source = descriptors.getRow(k);
+		auto row = _data.data() + size_t(k) * _stride;
+		auto squaredNorm = 0;
+		for (auto i = 0; i < _dimension; ++i) {
+			const auto value = int(std::lround(std::min(std::max(source[i] * DESCRIPTOR_QUANTIZATION_SCALE, 0.f), 255.f)));
+			row[i] = uint8_t(value);
+			squaredNorm += value * value;
+		}
+		_squaredNorms[k] = squaredNorm;
+	}
+}
+
+void QuantizedDescriptorSet::getRawDistances(const int index, const QuantizedDescriptorSet &train, const int begin, const int end, int *result) const
+{
+	Q_ASSERT(sameLayout(train));
+	if (begin >= end) {
+		return;
+	}
+	SimdKernels::dotProducts(result, getRow(index), train.getRow(begin), _stride, end - begin);
+	const auto squaredNorm = _squaredNorms[index];
+	for (auto k = begin; k < end; ++k) {
+		result[k - begin] = squaredNorm + train._squaredNorms[k] - 2 * result[k - begin];
+	}
+}
+
+double QuantizedDescriptorSet::toDistance(const int rawDistance)
+{
+	return std::sqrt(double(rawDistance)) / DESCRIPTOR_QUANTIZATION_SCALE;
+}
@@ -0,0 +1,45 @@
+#ifndef COMPUTERVISION_QUANTIZEDDESCRIPTORSET_H
+#define COMPUTERVISION_QUANTIZEDDESCRIPTORSET_H
+
+#include <vector>
+#include <cstdint>
+#include <qglobal.h>
+#include "AlignedAllocator.h"
+#include "ConstantValues.h"
+
+class DescriptorSet;
+
+// 8-bit copy of the rows of a DescriptorSet, a quarter of its size: normalized
+// values are scaled by DESCRIPTOR_QUANTIZATION_SCALE, rounded and clamped to 255.
+// Squared distances are exact integers computed as |a|^2 + |b|^2 - 2 * a.b with
+// the squared norms kept per row. Row i belongs to keypoint i of the source set.
+class QuantizedDescriptorSet
+{
+	int _dimension;
+	int _stride;
+	std::vector<uint8_t, AlignedAllocator<uint8_t>> _data;
+	std::vector<int> _squaredNorms;
+
+public:
+	explicit QuantizedDescriptorSet(const DescriptorSet &descriptors);
+
+	int getCount() const { return int(_squaredNorms.size()); }
+	int getDimension() const { return _dimension; }
+	int getStride() const { return _stride; }
+
+	const uint8_t *getRow(const int index) const {
+		Q_ASSERT(index >= 0 && index < getCount());
+		return _data.data() + size_t(index) * _stride;
+	}
+
+	int getSquaredNorm(const int index) const { return _squaredNorms[index]; }
+
+	// Squared distances from row index to train rows [begin, end), the raw
+	// distances the matcher ranks by.
+	void getRawDistances(const int index, const QuantizedDescriptorSet &train, const int begin, const int end, int *result) const;
+	// Raw distance in the units of DescriptorSet::distance.
+	static double toDistance(const int rawDistance);
+	bool sameLayout(const QuantizedDescriptorSet &other) const { return _stride == other._stride; }
+};
+
+#endif
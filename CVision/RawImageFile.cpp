@@ -0,0 +1,87 @@
+#include "RawImageFile.h"
+#include "ConstantValues.h"
+#include <QFile>
+#include <QString>
+
+namespace {
+
+const uint32_t RAW_IMAGE_MAGIC = 0x49525643; // "CVRI"
+const uint32_t RAW_IMAGE_VERSION = 1;
+
+uint64_t alignOffset(const uint64_t offset) {
+	return (offset + SIMD_ALIGNMENT - 1) / SIMD_ALIGNMENT * SIMD_ALIGNMENT;
+}
+
+uint64_t getLevelSize(const RawImageLevel &level) {
+	return uint64_t(level.height) * level.width * sizeof(float);
+}
+}
+
+bool RawImageFile::write(const QString &fileName, const int scalesPerOctave, std::vector<RawImageLevel> levels, const std::vector<const float *> &pixels)
+{
+	Q_ASSERT(levels.size() == pixels.size());
+	auto offset = uint64_t(sizeof(RawImageHeader) + levels.size() * sizeof(RawImageLevel));
+	for (auto &level : levels) {
+		if (level.scale == 0) {
+			offset = alignOffset(offset);
+		}
+		level.offset = offset;
+		offset += getLevelSize(level);
+	}
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly)) {
+		return false;
+	}
+	const auto header = RawImageHeader{ RAW_IMAGE_MAGIC, RAW_IMAGE_VERSION, RawPixelType::FLOAT32, uint32_t(scalesPerOctave), uint32_t(levels.size()), 0 };
+	auto written = uint64_t(file.write(reinterpret_cast<const char *>(&header), sizeof(header)));
+	written += file.write(reinterpret_cast<const char *>(levels.data()), qint64(levels.size() * sizeof(RawImageLevel)));
+	const char padding[SIMD_ALIGNMENT] = {};
+	for (auto i = 0; i < int(levels.size()); ++i) {
+		written += file.write(padding, qint64(levels[i].offset - written));
+		written += file.write(reinterpret_cast<const char *>(pixels[i]), qint64(getLevelSize(levels[i])));
+	}
+	return written == offset;
+}
+
+RawImageFile RawImageFile::map(const QString &fileName)
+{
+	auto result = RawImageFile();
+	auto file = std::make_shared<QFile>(fileName);
+	if (!file->open(QIODevice::ReadOnly) || uint64_t(file->size()) < sizeof(RawImageHeader)) {
+		return result;
+	}
+	const auto fileSize = uint64_t(file->size());
+	const auto data = file->map(0, file->size());
+	if (data == nullptr) {
+		return result;
+	}
+	const auto header = reinterpret_cast<const RawImageHeader *>(data);
+	if (header->magic != RAW_IMAGE_MAGIC || header->version != RAW_IMAGE_VERSION || header->pixelType != RawPixelType::FLOAT32
+		|| sizeof(RawImageHeader) + uint64_t(header->levelsCount) * sizeof(RawImageLevel) > fileSize) {
+		return result;
+	}
+	const auto levels = reinterpret_cast<const RawImageLevel *>(data + sizeof(RawImageHeader));
+	for (auto i = 0u; i < header->levelsCount; ++i) {
+		const auto &level = levels[i];
+		if (level.height < 0 || level.width < 0 || level.offset % sizeof(float) != 0 || level.offset + getLevelSize(level) > fileSize) {
+			return result;
+		}
+	}
+	result._levels.assign(levels, levels + header->levelsCount);
+	result._scalesPerOctave = int(header->scalesPerOctave);
+	result._file = file;
+	result._data = data;
+	return result;
+}
+
+std::shared_ptr<const float> RawImageFile::getData(const int index) const
+{
+	Q_ASSERT(!isNull() && index >= 0 && index < getLevelsCount());
+	return std::shared_ptr<const float>(_file, reinterpret_cast<const float *>(_data + _levels[index].offset));
+}
+
+ImageView RawImageFile::getView(const int index) const
+{
+	const auto data = getData(index);
+	return ImageView(data.get(), _levels[index].height, _levels[index].width, data);
+}
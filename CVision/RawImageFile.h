@@ -0,0 +1,60 @@
+#ifndef COMPUTERVISION_RAWIMAGEFILE_H
+#define COMPUTERVISION_RAWIMAGEFILE_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <qglobal.h>
+#include "ImageView.h"
+
+class QFile;
+class QString;
+
+enum class RawPixelType : uint32_t { FLOAT32 = 0 };
+
+struct RawImageHeader {
+	uint32_t magic;
+	uint32_t version;
+	RawPixelType pixelType;
+	uint32_t scalesPerOctave;
+	uint32_t levelsCount;
+	uint32_t reserved;
+};
+
+struct RawImageLevel {
+	int32_t octave;
+	int32_t scale;
+	int32_t height;
+	int32_t width;
+	double sigma;
+	uint64_t offset;
+};
+
+// Uncompressed container for images and pyramids that is read back with
+// QFile::map instead of decoding: a RawImageHeader, a table of levelsCount
+// RawImageLevel entries, then the pixels of every level at its offset in
+// native byte order. Levels of one octave are stored back to back and every
+// octave starts on a SIMD_ALIGNMENT boundary.
+// Views handed out by a mapped file keep the mapping alive and are read-only.
+class RawImageFile
+{
+	std::shared_ptr<QFile> _file;
+	const uchar *_data = nullptr;
+	int _scalesPerOctave = 0;
+	std::vector<RawImageLevel> _levels;
+
+public:
+	// levels give octave, scale, size and sigma; offsets are assigned on write.
+	static bool write(const QString &fileName, const int scalesPerOctave, std::vector<RawImageLevel> levels, const std::vector<const float *> &pixels);
+	// Returns a null file if fileName is missing, truncated or not in this format.
+	static RawImageFile map(const QString &fileName);
+
+	bool isNull() const { return _data == nullptr; }
+	int getScalesPerOctave() const { return _scalesPerOctave; }
+	int getLevelsCount() const { return int(_levels.size()); }
+	const RawImageLevel &getLevel(const int index) const { return _levels[index]; }
+	std::shared_ptr<const float> getData(const int index) const;
+	ImageView getView(const int index) const;
+};
+
+#endif
@@ -1,61 +1,268 @@
 #include "ScalePyramid.h"
 #include "Image.h"
+#include "ThreadPool.h"
+#include "BufferPool.h"
+#include "RawImageFile.h"
+#include "Trace.h"
 #include <QString>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
 
-ScalePyramid ScalePyramid::build(const Image& image, const int scalesPerOctaveCount, const double baseSigma, const double sigma) {
-	Q_ASSERT(baseSigma <= sigma);
+struct ScalePyramid::LazyLevels {
+	struct Level {
+		std::shared_ptr<float> data;
+		bool computing = false;
+		int64_t lastUse = 0;
+	};
+
+	Image source;
+	double initialDeltaSigma;
+	int maxCachedScales;
+	std::vector<std::vector<Level>> levels;
+	int cachedCount = 0;
+	int64_t useClock = 0;
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	LazyLevels(const Image &image, const double deltaSigma, const int maxCached)
+		: source(image), initialDeltaSigma(deltaSigma), maxCachedScales(maxCached)
+	{
+	}
+
+	void evict(const int keepOctave, const int keepScale)
+	{
+		while (maxCachedScales > 0 && cachedCount > maxCachedScales) {
+			Level *oldest = nullptr;
+			for (auto i = 0; i < int(levels.size()); ++i) {
+				for (auto j = 0; j < int(levels[i].size()); ++j) {
+					auto &level = levels[i][j];
+					if (level.data == nullptr || (i == keepOctave && j == keepScale)) {
+						continue;
+					}
+					if (oldest == nullptr || level.lastUse < oldest->lastUse) {
+						oldest = &level;
+					}
+				}
+			}
+			if (oldest == nullptr) {
+				return;
+			}
+			oldest->data = nullptr;
+			--cachedCount;
+		}
+	}
+};
+
+int ScalePyramid::getOctavesCount(const Image &image)
+{
 	const auto minImageSize = 32;
 	const auto minDim = std::min(image.getHeight(), image.getWidth());
-	const auto octavesCount = int(log2(minDim)) - int(log2(minImageSize)) + 1;
+	if (minDim < minImageSize) {
+		return 0;
+	}
+	return int(log2(minDim)) - int(log2(minImageSize)) + 1;
+}
+
+ScalePyramid ScalePyramid::build(const Image& image, const int scalesPerOctaveCount, const double baseSigma, const double sigma) {
+	Q_ASSERT(baseSigma <= sigma);
+	TRACE_SCOPE_IMAGE("ScalePyramid::build", image.getHeight(), image.getWidth());
+	const auto octavesCount = getOctavesCount(image);
 	auto result = ScalePyramid(scalesPerOctaveCount);
-	const auto k = pow(2.0, 1.0 / result.scalesPerOctaveCount());
-	auto curSigma = sigma;
-	auto curImage = image.gauss(sqrt(sigma * sigma - baseSigma * baseSigma));
-	for (auto i = 0; i < octavesCount; ++i) {
-		auto octave = std::vector<std::pair<Image, double>>(result.scalesPerOctaveCount());
-		for (auto j = 0; j < octave.size(); ++j) {
-			octave[j].first = curImage;
-			octave[j].second = curSigma;
-			const auto newSigma = curSigma * k;
-			const auto deltaSigma = sqrt(newSigma * newSigma - curSigma * curSigma);
-			curImage = curImage.gauss(deltaSigma);
-			curSigma = newSigma;
-		}
-		result.pushOctave(octave);
-		curSigma = curSigma / 2;
-		curImage = curImage.downSample();
+	result._sigma = sigma;
+	for (auto i = 0, height = image.getHeight(), width = image.getWidth(); i < octavesCount; ++i, height /= 2, width /= 2) {
+		result.addOctave(height, width);
+	}
+	if (octavesCount <= 0) {
+		return result;
 	}
+	{
+		TRACE_SCOPE_IMAGE("ScalePyramid::level", image.getHeight(), image.getWidth());
+		TRACE_SET_LEVEL(0, 0);
+		Image::gaussInto(image.getView(), sqrt(sigma * sigma - baseSigma * baseSigma), BorderEffectType::COPY, result.getScaleData(0, 0));
+	}
+	result.buildOctave(0);
 	return result;
 }
 
+ScalePyramid ScalePyramid::buildLazy(const Image& image, const int scalesPerOctaveCount, const double baseSigma, const double sigma, const int maxCachedScales) {
+	Q_ASSERT(baseSigma <= sigma);
+	const auto octavesCount = std::max(0, getOctavesCount(image));
+	auto result = ScalePyramid(scalesPerOctaveCount);
+	result._sigma = sigma;
+	for (auto i = 0, height = image.getHeight(), width = image.getWidth(); i < octavesCount; ++i, height /= 2, width /= 2) {
+		result.addOctave(height, width, false);
+	}
+	result._lazy = std::make_shared<LazyLevels>(image, sqrt(sigma * sigma - baseSigma * baseSigma), maxCachedScales);
+	result._lazy->levels.resize(octavesCount, std::vector<LazyLevels::Level>(scalesPerOctaveCount));
+	return result;
+}
+
+ImageView ScalePyramid::getLazyScale(const int octave, const int scale) const
+{
+	auto &lazy = *_lazy;
+	const auto &layout = _octaves[octave];
+	std::unique_lock<std::mutex> lock(lazy.mutex);
+	auto &level = lazy.levels[octave][scale];
+	while (level.data == nullptr && level.computing) {
+		lazy.condition.wait(lock);
+	}
+	if (level.data != nullptr) {
+		level.lastUse = ++lazy.useClock;
+		return ImageView(level.data.get(), layout.height, layout.width, level.data);
+	}
+	level.computing = true;
+	lock.unlock();
+
+	const auto data = BufferPool::instance().allocateShared(size_t(layout.height) * layout.width);
+	if (scale > 0) {
+		Image::gaussInto(getLazyScale(octave, 0), getScaleDeltaSigma(scale), BorderEffectType::COPY, data.get());
+	}
+	else if (octave > 0) {
+		Image::gaussDownSampleInto(getLazyScale(octave - 1, 0), _sigma * sqrt(3.), BorderEffectType::COPY, data.get());
+	}
+	else {
+		Image::gaussInto(lazy.source.getView(), lazy.initialDeltaSigma, BorderEffectType::COPY, data.get());
+	}
+
+	lock.lock();
+	level.data = data;
+	level.computing = false;
+	level.lastUse = ++lazy.useClock;
+	++lazy.cachedCount;
+	lazy.evict(octave, scale);
+	lazy.condition.notify_all();
+	return ImageView(data.get(), layout.height, layout.width, data);
+}
+
+double ScalePyramid::getScaleDeltaSigma(const int scale) const
+{
+	const auto scaleSigma = _octaves.front().sigmas[scale];
+	return sqrt(scaleSigma * scaleSigma - _sigma * _sigma);
+}
+
+// Every scale is blurred from the octave base with its absolute sigma, so the
+// scales are independent tasks. Task 0 produces the next octave base (sigma * 2,
+// then decimated) and builds that octave right away, overlapping the octaves.
+void ScalePyramid::buildOctave(const int octave)
+{
+	const auto base = getScale(octave, 0);
+	ThreadPool::instance().parallelFor(0, scalesPerOctaveCount(), [&](const int taskBegin, const int taskEnd) {
+		for (auto j = taskBegin; j < taskEnd; ++j) {
+			if (j == 0) {
+				if (octave + 1 < octavesCount()) {
+					{
+						TRACE_SCOPE_IMAGE("ScalePyramid::level", _octaves[octave + 1].height, _octaves[octave + 1].width);
+						TRACE_SET_LEVEL(octave + 1, 0);
+						Image::gaussDownSampleInto(base, _sigma * sqrt(3.), BorderEffectType::COPY, getScaleData(octave + 1, 0));
+					}
+					buildOctave(octave + 1);
+				}
+				continue;
+			}
+			TRACE_SCOPE_IMAGE("ScalePyramid::level", base.getHeight(), base.getWidth());
+			TRACE_SET_LEVEL(octave, j);
+			Image::gaussInto(base, getScaleDeltaSigma(j), BorderEffectType::COPY, getScaleData(octave, j));
+		}
+	});
+}
+
+ScalePyramid::Octave &ScalePyramid::addOctave(const int height, const int width, const bool allocate)
+{
+	const auto size = size_t(scalesPerOctaveCount()) * height * width;
+	auto sigmas = std::vector<double>(scalesPerOctaveCount());
+	const auto k = pow(2.0, 1.0 / scalesPerOctaveCount());
+	for (auto j = 0; j < scalesPerOctaveCount(); ++j) {
+		sigmas[j] = _sigma * pow(k, j);
+	}
+	auto data = allocate ? BufferPool::instance().allocateShared(size) : nullptr;
+	_octaves.push_back(Octave{ height, width, data, sigmas });
+	return _octaves.back();
+}
+
+float *ScalePyramid::getScaleData(const int octave, const int scale) const
+{
+	Q_ASSERT(contains(octave, scale));
+	const auto &data = _octaves[octave];
+	return data.data.get() + size_t(scale) * data.height * data.width;
+}
+
 double ScalePyramid::getSigma(const int octave, const int scale) const
 {
 	Q_ASSERT(contains(octave, scale));
-	return _octaves[octave][scale].second;
+	return _octaves[octave].sigmas[scale];
 }
 void ScalePyramid::saveAsImageSet(const QString &resultFolder) const
 {
 	for (auto i = 0; i < octavesCount(); ++i) {
 		for (auto j = 0; j < scalesPerOctaveCount(); ++j) {
-			auto s = getSigma(i, j);
-			auto str = "octave_"
-				+ QString::number(i + 1)
-				+ "___scale_"
-				+ QString::number(j)
-				+ "___sigma_"
-				+ QString::number(s) + ".jpg";
-			getScale(i, j).saveAsImage(resultFolder + "/" + str);
+			Image(getScale(i, j)).saveAsImage(resultFolder + "/" + getScaleFileName(i, j));
 		}
 	}
 }
 
-void ScalePyramid::pushOctave(const std::vector<std::pair<Image, double>>& octave)
+QString ScalePyramid::getScaleFileName(const int octave, const int scale) const
 {
-	_octaves.push_back(octave);
+	return "octave_"
+		+ QString::number(octave + 1)
+		+ "___scale_"
+		+ QString::number(scale)
+		+ "___sigma_"
+		+ QString::number(getSigma(octave, scale)) + ".jpg";
 }
 
-Image ScalePyramid::getScale(const int octave, const int scale) const
+bool ScalePyramid::saveAsRaw(const QString &filename) const
+{
+	auto levels = std::vector<RawImageLevel>();
+	auto views = std::vector<ImageView>();
+	for (auto i = 0; i < octavesCount(); ++i) {
+		for (auto j = 0; j < scalesPerOctaveCount(); ++j) {
+			views.push_back(getScale(i, j));
+			levels.push_back(RawImageLevel{ i, j, views.back().getHeight(), views.back().getWidth(), getSigma(i, j), 0 });
+		}
+	}
+	auto pixels = std::vector<const float *>();
+	for (const auto &view : views) {
+		pixels.push_back(view.getData());
+	}
+	return RawImageFile::write(filename, scalesPerOctaveCount(), levels, pixels);
+}
+
+ScalePyramid ScalePyramid::mapRaw(const QString &filename)
+{
+	const auto file = RawImageFile::map(filename);
+	const auto scalesCount = file.getScalesPerOctave();
+	if (file.isNull() || scalesCount <= 0 || file.getLevelsCount() % scalesCount != 0) {
+		return ScalePyramid(0);
+	}
+	auto result = ScalePyramid(scalesCount);
+	for (auto index = 0; index < file.getLevelsCount(); ++index) {
+		const auto &level = file.getLevel(index);
+		if (level.octave != index / scalesCount || level.scale != index % scalesCount) {
+			return ScalePyramid(0);
+		}
+		const auto &first = file.getLevel(index - level.scale);
+		if (level.height != first.height || level.width != first.width
+			|| level.offset != first.offset + uint64_t(level.scale) * level.height * level.width * sizeof(float)) {
+			return ScalePyramid(0);
+		}
+		if (level.scale == 0) {
+			// The arena is never written once the pyramid is built.
+			const auto data = std::const_pointer_cast<float>(file.getData(index));
+			result._octaves.push_back(Octave{ level.height, level.width, data, std::vector<double>() });
+		}
+		result._octaves.back().sigmas.push_back(level.sigma);
+	}
+	result._sigma = result.octavesCount() > 0 ? result.getSigma(0, 0) : 0;
+	return result;
+}
+
+ImageView ScalePyramid::getScale(const int octave, const int scale) const
 {
 	Q_ASSERT(contains(octave, scale));
-	return _octaves[octave][scale].first;
+	if (isLazy()) {
+		return getLazyScale(octave, scale);
+	}
+	const auto &data = _octaves[octave];
+	return ImageView(getScaleData(octave, scale), data.height, data.width, data.data);
 }
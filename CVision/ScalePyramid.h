@@ -2,13 +2,36 @@
 #define COMPUTERVISION_SCALEPYRAMID_H
 
 #include <vector>
+#include <memory>
+#include "ImageView.h"
 
 class Image;
 class QString;
 
+// Every octave keeps its scales in one arena of scalesPerOctave * height * width
+// floats; getScale returns views into it that also keep the arena alive.
+// A lazy pyramid computes a scale (and the octave bases it depends on) the
+// first time getScale asks for it; see buildLazy.
 class ScalePyramid {
+	struct Octave {
+		int height;
+		int width;
+		std::shared_ptr<float> data;
+		std::vector<double> sigmas;
+	};
+	struct LazyLevels;
+
 	int _scalesPerOctave;
-	std::vector<std::vector<std::pair<Image, double>>> _octaves;
+	double _sigma = 0;
+	std::vector<Octave> _octaves;
+	std::shared_ptr<LazyLevels> _lazy;
+
+	static int getOctavesCount(const Image &image);
+	Octave &addOctave(const int height, const int width, const bool allocate = true);
+	float *getScaleData(const int octave, const int scale) const;
+	void buildOctave(const int octave);
+	double getScaleDeltaSigma(const int scale) const;
+	ImageView getLazyScale(const int octave, const int scale) const;
 
 public:
 	explicit ScalePyramid(const int scalesPerOctave)
@@ -21,6 +44,15 @@ public:
 		const double baseSigma,
 		const double sigma);
 
+	// Keeps a copy of image and blurs nothing up front. maxCachedScales > 0 caps
+	// the number of memoized scales, evicting the least recently used one;
+	// views returned earlier stay valid. getScale is safe to call concurrently.
+	static ScalePyramid buildLazy(const Image& image,
+		const int scalesPerOctave,
+		const double baseSigma,
+		const double sigma,
+		const int maxCachedScales = 0);
+
 	int octavesCount() const {
 		return _octaves.size();
 	}
@@ -29,6 +61,10 @@ public:
 		return _scalesPerOctave;
 	}
 
+	bool isLazy() const {
+		return _lazy != nullptr;
+	}
+
 	bool contains(const int octave, const int scale) const
 	{
 		return octave >= 0 && octave < octavesCount() && scale >= 0 && scale < scalesPerOctaveCount();
@@ -36,7 +72,12 @@ public:
 
 	double getSigma(const int octave, const int scale) const;
 	void saveAsImageSet(const QString &resultFolder) const;
-	void pushOctave(const std::vector<std::pair<Image, double>>& octave);
-	Image getScale(const int octave, const int scale) const;
+	QString getScaleFileName(const int octave, const int scale) const;
+	// Every scale with its octave, index and sigma in one RawImageFile.
+	// mapRaw returns a pyramid whose octave arenas are the read-only file
+	// mapping, or an empty pyramid if the file cannot be mapped.
+	bool saveAsRaw(const QString &filename) const;
+	static ScalePyramid mapRaw(const QString &filename);
+	ImageView getScale(const int octave, const int scale) const;
 };
 #endif 
@@ -0,0 +1,503 @@
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET_SSE42
+#define SIMD_TARGET_AVX2
+#define SIMD_TARGET_POPCNT
+#else
+#define SIMD_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SIMD_TARGET_POPCNT __attribute__((target("sse4.2,popcnt")))
+#endif
+#endif
+
+namespace {
+
+struct KernelsTable {
+	void(*multiply)(float *, const float *, const float *, const int);
+	void(*subtract)(float *, const float *, const float *, const int);
+	void(*sqrSum)(float *, const float *, const float *, const int);
+	void(*hypo)(float *, const float *, const float *, const int);
+	void(*divide)(float *, const float *, const float, const int);
+	void(*axpy)(float *, const float *, const float, const int);
+	void(*convolveLine)(float *, const float *, const float *, const int, const int);
+	void(*minMax)(const float *, const int, float &, float &);
+	void(*normalize)(float *, const int, const float, const float);
+	void(*luminance)(float *, const uint32_t *, const float, const float, const float, const int);
+	void(*dotProducts)(int *, const uint8_t *, const uint8_t *, const int, const int);
+	void(*hammingDistances)(int *, const uint64_t *, const uint64_t *, const int, const int);
+};
+
+namespace scalar {
+
+void multiply(float *result, const float *a, const float *b, const int size) {
+	for (auto i = 0; i < size; ++i)
+		result[i] = a[i] * b[i];
+}
+
+void subtract(float *result, const float *a, const float *b, const int size) {
+	for (auto i = 0; i < size; ++i)
+		result[i] = a[i] - b[i];
+}
+
+void sqrSum(float *result, const float *a, const float *b, const int size) {
+	for (auto i = 0; i < size; ++i)
+		result[i] = a[i] * a[i] + b[i] * b[i];
+}
+
+void hypo(float *result, const float *a, const float *b, const int size) {
+	for (auto i = 0; i < size; ++i)
+		result[i] = std::sqrt(a[i] * a[i] + b[i] * b[i]);
+}
+
+void divide(float *result, const float *source, const float divider, const int size) {
+	for (auto i = 0; i < size; ++i)
+		result[i] = source[i] / divider;
+}
+
+void axpy(float *result, const float *source, const float weight, const int size) {
+	for (auto i = 0; i < size; ++i)
+		result[i] += source[i] * weight;
+}
+
+void convolveLine(float *result, const float *line, const float *kernel, const int kernelSize, const int size) {
+	for (auto j = 0; j < size; ++j) {
+		auto value = .0f;
+		for (auto v = 0; v < kernelSize; ++v)
+			value += line[j + v] * kernel[v];
+		result[j] = value;
+	}
+}
+
+void minMax(const float *source, const int size, float &minValue, float &maxValue) {
+	minValue = *std::min_element(source, source + size);
+	maxValue = *std::max_element(source, source + size);
+}
+
+void normalize(float *data, const int size, const float minValue, const float range) {
+	for (auto i = 0; i < size; ++i)
+		data[i] = (data[i] - minValue) / range;
+}
+
+void luminance(float *result, const uint32_t *pixels, const float redWeight, const float greenWeight, const float blueWeight, const int size) {
+	for (auto i = 0; i < size; ++i)
+		result[i] = redWeight * float((pixels[i] >> 16) & 0xff) + greenWeight * float((pixels[i] >> 8) & 0xff) + blueWeight * float(pixels[i] & 0xff);
+}
+
+void dotProducts(int *result, const uint8_t *query, const uint8_t *rows, const int dimension, const int count) {
+	for (auto k = 0; k < count; ++k) {
+		const auto row = rows + size_t(k) * dimension;
+		auto sum = 0;
+		for (auto i = 0; i < dimension; ++i)
+			sum += int(query[i]) * int(row[i]);
+		result[k] = sum;
+	}
+}
+
+int popcount(uint64_t x) {
+	x = x - ((x >> 1) & 0x5555555555555555ull);
+	x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+	return int((x * 0x0101010101010101ull) >> 56);
+}
+
+void hammingDistances(int *result, const uint64_t *query, const uint64_t *rows, const int words, const int count) {
+	for (auto k = 0; k < count; ++k) {
+		const auto row = rows + size_t(k) * words;
+		auto sum = 0;
+		for (auto i = 0; i < words; ++i)
+			sum += popcount(query[i] ^ row[i]);
+		result[k] = sum;
+	}
+}
+
+const KernelsTable table = { multiply, subtract, sqrSum, hypo, divide, axpy, convolveLine, minMax, normalize, luminance, dotProducts, hammingDistances };
+}
+
+#ifdef SIMD_X86
+namespace sse42 {
+
+SIMD_TARGET_SSE42 void multiply(float *result, const float *a, const float *b, const int size) {
+	auto i = 0;
+	for (; i + 4 <= size; i += 4)
+		_mm_storeu_ps(result + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+	scalar::multiply(result + i, a + i, b + i, size - i);
+}
+
+SIMD_TARGET_SSE42 void subtract(float *result, const float *a, const float *b, const int size) {
+	auto i = 0;
+	for (; i + 4 <= size; i += 4)
+		_mm_storeu_ps(result + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+	scalar::subtract(result + i, a + i, b + i, size - i);
+}
+
+SIMD_TARGET_SSE42 void sqrSum(float *result, const float *a, const float *b, const int size) {
+	auto i = 0;
+	for (; i + 4 <= size; i += 4) {
+		const auto x = _mm_loadu_ps(a + i);
+		const auto y = _mm_loadu_ps(b + i);
+		_mm_storeu_ps(result + i, _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+	}
+	scalar::sqrSum(result + i, a + i, b + i, size - i);
+}
+
+SIMD_TARGET_SSE42 void hypo(float *result, const float *a, const float *b, const int size) {
+	auto i = 0;
+	for (; i + 4 <= size; i += 4) {
+		const auto x = _mm_loadu_ps(a + i);
+		const auto y = _mm_loadu_ps(b + i);
+		_mm_storeu_ps(result + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))));
+	}
+	scalar::hypo(result + i, a + i, b + i, size - i);
+}
+
+SIMD_TARGET_SSE42 void divide(float *result, const float *source, const float divider, const int size) {
+	const auto d = _mm_set1_ps(divider);
+	auto i = 0;
+	for (; i + 4 <= size; i += 4)
+		_mm_storeu_ps(result + i, _mm_div_ps(_mm_loadu_ps(source + i), d));
+	scalar::divide(result + i, source + i, divider, size - i);
+}
+
+SIMD_TARGET_SSE42 void axpy(float *result, const float *source, const float weight, const int size) {
+	const auto w = _mm_set1_ps(weight);
+	auto i = 0;
+	for (; i + 4 <= size; i += 4)
+		_mm_storeu_ps(result + i, _mm_add_ps(_mm_loadu_ps(result + i), _mm_mul_ps(_mm_loadu_ps(source + i), w)));
+	scalar::axpy(result + i, source + i, weight, size - i);
+}
+
+SIMD_TARGET_SSE42 void convolveLine(float *result, const float *line, const float *kernel, const int kernelSize, const int size) {
+	auto j = 0;
+	for (; j + 4 <= size; j += 4) {
+		auto value = _mm_setzero_ps();
+		for (auto v = 0; v < kernelSize; ++v)
+			value = _mm_add_ps(value, _mm_mul_ps(_mm_loadu_ps(line + j + v), _mm_set1_ps(kernel[v])));
+		_mm_storeu_ps(result + j, value);
+	}
+	scalar::convolveLine(result + j, line + j, kernel, kernelSize, size - j);
+}
+
+SIMD_TARGET_SSE42 void minMax(const float *source, const int size, float &minValue, float &maxValue) {
+	if (size < 4) {
+		scalar::minMax(source, size, minValue, maxValue);
+		return;
+	}
+	auto minVector = _mm_loadu_ps(source);
+	auto maxVector = minVector;
+	auto i = 4;
+	for (; i + 4 <= size; i += 4) {
+		const auto x = _mm_loadu_ps(source + i);
+		minVector = _mm_min_ps(minVector, x);
+		maxVector = _mm_max_ps(maxVector, x);
+	}
+	float mins[4], maxs[4];
+	_mm_storeu_ps(mins, minVector);
+	_mm_storeu_ps(maxs, maxVector);
+	minValue = *std::min_element(mins, mins + 4);
+	maxValue = *std::max_element(maxs, maxs + 4);
+	for (; i < size; ++i) {
+		minValue = std::min(minValue, source[i]);
+		maxValue = std::max(maxValue, source[i]);
+	}
+}
+
+SIMD_TARGET_SSE42 void normalize(float *data, const int size, const float minValue, const float range) {
+	const auto m = _mm_set1_ps(minValue);
+	const auto r = _mm_set1_ps(range);
+	auto i = 0;
+	for (; i + 4 <= size; i += 4)
+		_mm_storeu_ps(data + i, _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(data + i), m), r));
+	scalar::normalize(data + i, size - i, minValue, range);
+}
+
+SIMD_TARGET_SSE42 void luminance(float *result, const uint32_t *pixels, const float redWeight, const float greenWeight, const float blueWeight, const int size) {
+	const auto mask = _mm_set1_epi32(0xff);
+	const auto r = _mm_set1_ps(redWeight);
+	const auto g = _mm_set1_ps(greenWeight);
+	const auto b = _mm_set1_ps(blueWeight);
+	auto i = 0;
+	for (; i + 4 <= size; i += 4) {
+		const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+		const auto red = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(x, 16), mask));
+		const auto green = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(x, 8), mask));
+		const auto blue = _mm_cvtepi32_ps(_mm_and_si128(x, mask));
+		_mm_storeu_ps(result + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, red), _mm_mul_ps(g, green)), _mm_mul_ps(b, blue)));
+	}
+	scalar::luminance(result + i, pixels + i, redWeight, greenWeight, blueWeight, size - i);
+}
+
+SIMD_TARGET_SSE42 void dotProducts(int *result, const uint8_t *query, const uint8_t *rows, const int dimension, const int count) {
+	for (auto k = 0; k < count; ++k) {
+		const auto row = rows + size_t(k) * dimension;
+		auto sum = _mm_setzero_si128();
+		for (auto i = 0; i < dimension; i += 8) {
+			const auto a = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(query + i)));
+			const auto b = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + i)));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(a, b));
+		}
+		sum = _mm_hadd_epi32(sum, sum);
+		sum = _mm_hadd_epi32(sum, sum);
+		result[k] = _mm_cvtsi128_si32(sum);
+	}
+}
+
+SIMD_TARGET_POPCNT void hammingDistances(int *result, const uint64_t *query, const uint64_t *rows, const int words, const int count) {
+	for (auto k = 0; k < count; ++k) {
+		const auto row = rows + size_t(k) * words;
+		auto sum = 0;
+		for (auto i = 0; i < words; ++i) {
+			const auto x = query[i] ^ row[i];
+#if defined(_M_X64) || defined(__x86_64__)
+			sum += int(_mm_popcnt_u64(x));
+#else
+			sum += _mm_popcnt_u32(uint32_t(x)) + _mm_popcnt_u32(uint32_t(x >> 32));
+#endif
+		}
+		result[k] = sum;
+	}
+}
+
+const KernelsTable table = { multiply, subtract, sqrSum, hypo, divide, axpy, convolveLine, minMax, normalize, luminance, dotProducts, hammingDistances };
+}
+
+namespace avx2 {
+
+SIMD_TARGET_AVX2 void multiply(float *result, const float *a, const float *b, const int size) {
+	auto i = 0;
+	for (; i + 8 <= size; i += 8)
+		_mm256_storeu_ps(result + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+	scalar::multiply(result + i, a + i, b + i, size - i);
+}
+
+SIMD_TARGET_AVX2 void subtract(float *result, const float *a, const float *b, const int size) {
+	auto i = 0;
+	for (; i + 8 <= size; i += 8)
+		_mm256_storeu_ps(result + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+	scalar::subtract(result + i, a + i, b + i, size - i);
+}
+
+SIMD_TARGET_AVX2 void sqrSum(float *result, const float *a, const float *b, const int size) {
+	auto i = 0;
+	for (; i + 8 <= size; i += 8) {
+		const auto x = _mm256_loadu_ps(a + i);
+		const auto y = _mm256_loadu_ps(b + i);
+		_mm256_storeu_ps(result + i, _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+	}
+	scalar::sqrSum(result + i, a + i, b + i, size - i);
+}
+
+SIMD_TARGET_AVX2 void hypo(float *result, const float *a, const float *b, const int size) {
+	auto i = 0;
+	for (; i + 8 <= size; i += 8) {
+		const auto x = _mm256_loadu_ps(a + i);
+		const auto y = _mm256_loadu_ps(b + i);
+		_mm256_storeu_ps(result + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y))));
+	}
+	scalar::hypo(result + i, a + i, b + i, size - i);
+}
+
+SIMD_TARGET_AVX2 void divide(float *result, const float *source, const float divider, const int size) {
+	const auto d = _mm256_set1_ps(divider);
+	auto i = 0;
+	for (; i + 8 <= size; i += 8)
+		_mm256_storeu_ps(result + i, _mm256_div_ps(_mm256_loadu_ps(source + i), d));
+	scalar::divide(result + i, source + i, divider, size - i);
+}
+
+SIMD_TARGET_AVX2 void axpy(float *result, const float *source, const float weight, const int size) {
+	const auto w = _mm256_set1_ps(weight);
+	auto i = 0;
+	for (; i + 8 <= size; i += 8)
+		_mm256_storeu_ps(result + i, _mm256_add_ps(_mm256_loadu_ps(result + i), _mm256_mul_ps(_mm256_loadu_ps(source + i), w)));
+	scalar::axpy(result + i, source + i, weight, size - i);
+}
+
+SIMD_TARGET_AVX2 void convolveLine(float *result, const float *line, const float *kernel, const int kernelSize, const int size) {
+	auto j = 0;
+	for (; j + 8 <= size; j += 8) {
+		auto value = _mm256_setzero_ps();
+		for (auto v = 0; v < kernelSize; ++v)
+			value = _mm256_add_ps(value, _mm256_mul_ps(_mm256_loadu_ps(line + j + v), _mm256_set1_ps(kernel[v])));
+		_mm256_storeu_ps(result + j, value);
+	}
+	scalar::convolveLine(result + j, line + j, kernel, kernelSize, size - j);
+}
+
+SIMD_TARGET_AVX2 void minMax(const float *source, const int size, float &minValue, float &maxValue) {
+	if (size < 8) {
+		scalar::minMax(source, size, minValue, maxValue);
+		return;
+	}
+	auto minVector = _mm256_loadu_ps(source);
+	auto maxVector = minVector;
+	auto i = 8;
+	for (; i + 8 <= size; i += 8) {
+		const auto x = _mm256_loadu_ps(source + i);
+		minVector = _mm256_min_ps(minVector, x);
+		maxVector = _mm256_max_ps(maxVector, x);
+	}
+	float mins[8], maxs[8];
+	_mm256_storeu_ps(mins, minVector);
+	_mm256_storeu_ps(maxs, maxVector);
+	minValue = *std::min_element(mins, mins + 8);
+	maxValue = *std::max_element(maxs, maxs + 8);
+	for (; i < size; ++i) {
+		minValue = std::min(minValue, source[i]);
+		maxValue = std::max(maxValue, source[i]);
+	}
+}
+
+SIMD_TARGET_AVX2 void normalize(float *data, const int size, const float minValue, const float range) {
+	const auto m = _mm256_set1_ps(minValue);
+	const auto r = _mm256_set1_ps(range);
+	auto i = 0;
+	for (; i + 8 <= size; i += 8)
+		_mm256_storeu_ps(data + i, _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(data + i), m), r));
+	scalar::normalize(data + i, size - i, minValue, range);
+}
+
+SIMD_TARGET_AVX2 void luminance(float *result, const uint32_t *pixels, const float redWeight, const float greenWeight, const float blueWeight, const int size) {
+	const auto mask = _mm256_set1_epi32(0xff);
+	const auto r = _mm256_set1_ps(redWeight);
+	const auto g = _mm256_set1_ps(greenWeight);
+	const auto b = _mm256_set1_ps(blueWeight);
+	auto i = 0;
+	for (; i + 8 <= size; i += 8) {
+		const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pixels + i));
+		const auto red = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(x, 16), mask));
+		const auto green = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(x, 8), mask));
+		const auto blue = _mm256_cvtepi32_ps(_mm256_and_si256(x, mask));
+		_mm256_storeu_ps(result + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r, red), _mm256_mul_ps(g, green)), _mm256_mul_ps(b, blue)));
+	}
+	scalar::luminance(result + i, pixels + i, redWeight, greenWeight, blueWeight, size - i);
+}
+
+// Rows are widened to 16 bits with the query widened once: madd of two
+// unsigned 8-bit values would need maddubs, which takes one of them signed.
+SIMD_TARGET_AVX2 void dotProducts(int *result, const uint8_t *query, const uint8_t *rows, const int dimension, const int count) {
+	const auto blocksCount = dimension / 16;
+	if (blocksCount > 16) {
+		sse42::dotProducts(result, query, rows, dimension, count);
+		return;
+	}
+	__m256i wideQuery[16];
+	for (auto b = 0; b < blocksCount; ++b)
+		wideQuery[b] = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(query + 16 * b)));
+	for (auto k = 0; k < count; ++k) {
+		const auto row = rows + size_t(k) * dimension;
+		auto sum = _mm256_setzero_si256();
+		for (auto b = 0; b < blocksCount; ++b) {
+			const auto x = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + 16 * b)));
+			sum = _mm256_add_epi32(sum, _mm256_madd_epi16(wideQuery[b], x));
+		}
+		auto half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		half = _mm_hadd_epi32(half, half);
+		half = _mm_hadd_epi32(half, half);
+		result[k] = _mm_cvtsi128_si32(half);
+	}
+}
+
+// Rows of a few words gain nothing from vector popcount emulation.
+const KernelsTable table = { multiply, subtract, sqrSum, hypo, divide, axpy, convolveLine, minMax, normalize, luminance, dotProducts, sse42::hammingDistances };
+}
+#endif
+
+const KernelsTable &currentTable() {
+	switch (SimdKernels::getLevel()) {
+#ifdef SIMD_X86
+	case SimdLevel::AVX2:
+		return avx2::table;
+	case SimdLevel::SSE42:
+		return sse42::table;
+#endif
+	default:
+		return scalar::table;
+	}
+}
+}
+
+SimdLevel SimdKernels::_level = SimdKernels::detectLevel();
+
+SimdLevel SimdKernels::detectLevel() {
+#if defined(SIMD_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	const auto maxLeaf = info[0];
+	__cpuid(info, 1);
+	// The SSE4.2 table also holds the POPCNT Hamming kernel, which AVX2 reuses.
+	const auto hasSse42 = (info[2] & (1 << 20)) != 0 && (info[2] & (1 << 23)) != 0;
+	const auto hasOsxsave = (info[2] & (1 << 27)) != 0;
+	auto hasAvx2 = false;
+	if (maxLeaf >= 7 && hasOsxsave && (_xgetbv(0) & 6) == 6) {
+		__cpuidex(info, 7, 0);
+		hasAvx2 = (info[1] & (1 << 5)) != 0;
+	}
+	return !hasSse42 ? SimdLevel::SCALAR : hasAvx2 ? SimdLevel::AVX2 : SimdLevel::SSE42;
+#elif defined(SIMD_X86)
+	__builtin_cpu_init();
+	const auto hasSse42 = __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+	return !hasSse42 ? SimdLevel::SCALAR : __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE42;
+#else
+	return SimdLevel::SCALAR;
+#endif
+}
+
+void SimdKernels::setLevel(const SimdLevel level) {
+	_level = std::min(level, detectLevel());
+}
+
+void SimdKernels::multiply(float *result, const float *a, const float *b, const int size) {
+	currentTable().multiply(result, a, b, size);
+}
+
+void SimdKernels::subtract(float *result, const float *a, const float *b, const int size) {
+	currentTable().subtract(result, a, b, size);
+}
+
+void SimdKernels::sqrSum(float *result, const float *a, const float *b, const int size) {
+	currentTable().sqrSum(result, a, b, size);
+}
+
+void SimdKernels::hypo(float *result, const float *a, const float *b, const int size) {
+	currentTable().hypo(result, a, b, size);
+}
+
+void SimdKernels::divide(float *result, const float *source, const float divider, const int size) {
+	currentTable().divide(result, source, divider, size);
+}
+
+void SimdKernels::axpy(float *result, const float *source, const float weight, const int size) {
+	currentTable().axpy(result, source, weight, size);
+}
+
+void SimdKernels::convolveLine(float *result, const float *line, const float *kernel, const int kernelSize, const int size) {
+	currentTable().convolveLine(result, line, kernel, kernelSize, size);
+}
+
+void SimdKernels::minMax(const float *source, const int size, float &minValue, float &maxValue) {
+	currentTable().minMax(source, size, minValue, maxValue);
+}
+
+void SimdKernels::normalize(float *data, const int size, const float minValue, const float range) {
+	currentTable().normalize(data, size, minValue, range);
+}
+
+void SimdKernels::luminance(float *result, const uint32_t *pixels, const float redWeight, const float greenWeight, const float blueWeight, const int size) {
+	currentTable().luminance(result, pixels, redWeight, greenWeight, blueWeight, size);
+}
+
+void SimdKernels::dotProducts(int *result, const uint8_t *query, const uint8_t *rows, const int dimension, const int count) {
+	currentTable().dotProducts(result, query, rows, dimension, count);
+}
+
+void SimdKernels::hammingDistances(int *result, const uint64_t *query, const uint64_t *rows, const int words, const int count) {
+	currentTable().hammingDistances(result, query, rows, words, count);
+}
@@ -0,0 +1,37 @@
+#ifndef COMPUTERVISION_SIMDKERNELS_H
+#define COMPUTERVISION_SIMDKERNELS_H
+
+#include <cstdint>
+
+enum class SimdLevel { SCALAR, SSE42, AVX2 };
+
+// Every level keeps the per-element operation order of the scalar loop and
+// never contracts to FMA, so results are bit-identical to SCALAR (tolerance 0).
+// The only exception is minMax on data containing NaN.
+class SimdKernels
+{
+	static SimdLevel _level;
+
+public:
+	static SimdLevel detectLevel();
+	static SimdLevel getLevel() { return _level; }
+	static void setLevel(const SimdLevel level);
+
+	static void multiply(float *result, const float *a, const float *b, const int size);
+	static void subtract(float *result, const float *a, const float *b, const int size);
+	static void sqrSum(float *result, const float *a, const float *b, const int size);
+	static void hypo(float *result, const float *a, const float *b, const int size);
+	static void divide(float *result, const float *source, const float divider, const int size);
+	static void axpy(float *result, const float *source, const float weight, const int size);
+	static void convolveLine(float *result, const float *line, const float *kernel, const int kernelSize, const int size);
+	static void minMax(const float *source, const int size, float &minValue, float &maxValue);
+	static void normalize(float *data, const int size, const float minValue, const float range);
+	// 0xAARRGGBB pixels (QImage::Format_RGB32) to weighted luminance.
+	static void luminance(float *result, const uint32_t *pixels, const float redWeight, const float greenWeight, const float blueWeight, const int size);
+	// One query row against count consecutive rows; dimension is a multiple of 32
+	// bytes. Integer results, so every level matches SCALAR exactly.
+	static void dotProducts(int *result, const uint8_t *query, const uint8_t *rows, const int dimension, const int count);
+	static void hammingDistances(int *result, const uint64_t *query, const uint64_t *rows, const int words, const int count);
+};
+
+#endif
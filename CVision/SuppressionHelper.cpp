@@ -0,0 +1,123 @@
+#include "SuppressionHelper.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+class RankedKdTree
+{
+	const std::vector<ImagePoint> &_points;
+	const std::vector<int> &_ranks;
+	std::vector<int> _nodes;
+	std::vector<int> _subtreeMinRank;
+
+	static int coordinate(const ImagePoint &point, const int axis) {
+		return axis == 0 ? point.getX() : point.getY();
+	}
+
+	int build(const int begin, const int end, const int axis) {
+		if (begin >= end) {
+			return INT32_MAX;
+		}
+		const auto middle = (begin + end) / 2;
+		std::nth_element(_nodes.begin() + begin, _nodes.begin() + middle, _nodes.begin() + end, [&](const int a, const int b) {
+			return coordinate(_points[a], axis) < coordinate(_points[b], axis);
+		});
+		const auto leftRank = build(begin, middle, 1 - axis);
+		const auto rightRank = build(middle + 1, end, 1 - axis);
+		_subtreeMinRank[middle] = std::min(_ranks[_nodes[middle]], std::min(leftRank, rightRank));
+		return _subtreeMinRank[middle];
+	}
+
+	void nearest(const int begin, const int end, const int axis, const int query, const int rankLimit, int64_t &best) const {
+		if (begin >= end) {
+			return;
+		}
+		const auto middle = (begin + end) / 2;
+		if (_subtreeMinRank[middle] >= rankLimit) {
+			return;
+		}
+		const auto node = _nodes[middle];
+		const auto &point = _points[node];
+		const auto &target = _points[query];
+		if (_ranks[node] < rankLimit && node != query) {
+			const auto dx = int64_t(point.getX() - target.getX());
+			const auto dy = int64_t(point.getY() - target.getY());
+			best = std::min(best, dx * dx + dy * dy);
+		}
+		const auto difference = int64_t(coordinate(target, axis) - coordinate(point, axis));
+		if (difference < 0) {
+			nearest(begin, middle, 1 - axis, query, rankLimit, best);
+			if (difference * difference < best) {
+				nearest(middle + 1, end, 1 - axis, query, rankLimit, best);
+			}
+		}
+		else {
+			nearest(middle + 1, end, 1 - axis, query, rankLimit, best);
+			if (difference * difference < best) {
+				nearest(begin, middle, 1 - axis, query, rankLimit, best);
+			}
+		}
+	}
+
+public:
+	RankedKdTree(const std::vector<ImagePoint> &points, const std::vector<int> &ranks)
+		: _points(points), _ranks(ranks), _nodes(points.size()), _subtreeMinRank(points.size())
+	{
+		std::iota(_nodes.begin(), _nodes.end(), 0);
+		build(0, int(_nodes.size()), 0);
+	}
+
+	int64_t nearestSquaredDistance(const int query, const int rankLimit) const {
+		auto best = SuppressionHelper::UNSUPPRESSED_RADIUS;
+		nearest(0, int(_nodes.size()), 0, query, rankLimit, best);
+		return best;
+	}
+};
+}
+
+const int64_t SuppressionHelper::UNSUPPRESSED_RADIUS;
+
+std::vector<int64_t> SuppressionHelper::getSquaredSuppressionRadii(const std::vector<ImagePoint> &points, const double filterValue)
+{
+	const auto count = int(points.size());
+	auto order = std::vector<int>(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](const int a, const int b) {
+		return points[a].getValue() > points[b].getValue();
+	});
+	auto ranks = std::vector<int>(count);
+	for (auto rank = 0; rank < count; ++rank) {
+		ranks[order[rank]] = rank;
+	}
+	const auto tree = RankedKdTree(points, ranks);
+	auto radii = std::vector<int64_t>(count, UNSUPPRESSED_RADIUS);
+	auto dominatingCount = 0;
+	for (auto rank = 0; rank < count; ++rank) {
+		const auto index = order[rank];
+		while (dominatingCount < count && filterValue * points[order[dominatingCount]].getValue() > points[index].getValue()) {
+			++dominatingCount;
+		}
+		radii[index] = tree.nearestSquaredDistance(index, dominatingCount);
+	}
+	return radii;
+}
+
+std::vector<ImagePoint> SuppressionHelper::adaptiveSuppression(const std::vector<ImagePoint> &points, const int limitCount, const double filterValue)
+{
+	const auto radii = getSquaredSuppressionRadii(points, filterValue);
+	auto order = std::vector<int>(points.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](const int a, const int b) {
+		return radii[a] != radii[b]
+			? radii[a] > radii[b]
+			: points[a].getValue() > points[b].getValue();
+	});
+	order.resize(std::min(order.size(), size_t(std::max(limitCount, 0))));
+	auto result = std::vector<ImagePoint>();
+	result.reserve(order.size());
+	for (auto index : order) {
+		result.push_back(points[index]);
+	}
+	return result;
+}
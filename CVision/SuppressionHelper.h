@@ -0,0 +1,21 @@
+#ifndef COMPUTERVISION_SUPPRESSIONHELPER_H
+#define COMPUTERVISION_SUPPRESSIONHELPER_H
+
+#include <vector>
+#include <cstdint>
+#include "ImagePoint.h"
+
+// Adaptive non-maximum suppression. The suppression radius of a point is the
+// distance to the nearest point that dominates it (filterValue * other > value).
+// Radii are found with a k-d tree whose nodes also keep the best value rank
+// in their subtree, so the search skips subtrees without dominating points.
+class SuppressionHelper
+{
+public:
+	static const int64_t UNSUPPRESSED_RADIUS = INT64_MAX;
+
+	static std::vector<int64_t> getSquaredSuppressionRadii(const std::vector<ImagePoint> &points, const double filterValue);
+	static std::vector<ImagePoint> adaptiveSuppression(const std::vector<ImagePoint> &points, const int limitCount, const double filterValue);
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "Tasks.h"
+#include <QPainter>
+#include "Image.h"
+#include "ScalePyramid.h"
+#include "ConstantValues.h"
+#include "DescriptorHelper.h"
+#include "Trace.h"
+
+namespace {
+	QImage decode(const QString &source)
+	{
+		TRACE_SCOPE("Tasks::decode");
+		return QImage(source);
+	}
+}
+
+std::vector<TaskOutput> Tasks::sobel(const QString &source, const QString &resultPath)
+{
+	const auto image = decode(source);
+	if (image.isNull()) {
+		return {};
+	}
+	return { { resultPath, Image::fromQImage(image).sobel().getNormalized().toGrayscaleQImage() } };
+}
+
+std::vector<TaskOutput> Tasks::scalePyramid(const QString &source, const QString &resultFolder)
+{
+	const auto image = decode(source);
+	if (image.isNull()) {
+		return {};
+	}
+	const auto pyramid = Image::fromQImage(image).buildScalePyramid(SCALES_PER_OCTAVE, BASE_SIGMA, SIGMA);
+	auto result = std::vector<TaskOutput>();
+	for (auto i = 0; i < pyramid.octavesCount(); ++i) {
+		for (auto j = 0; j < pyramid.scalesPerOctaveCount(); ++j) {
+			result.push_back({ resultFolder + "/" + pyramid.getScaleFileName(i, j), Image(pyramid.getScale(i, j)).toGrayscaleQImage() });
+		}
+	}
+	return result;
+}
+
+std::vector<TaskOutput> Tasks::interestingPoints(const QString &source, const QString &resultFolder)
+{
+	const auto sourceImage = decode(source);
+	if (sourceImage.isNull()) {
+		return {};
+	}
+	const auto image = Image::fromQImage(sourceImage);
+	const auto moravecPoints = image.moravec(MORAVEC_SHIFT).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
+	const auto harrisPoints = image.harris(HARRIS_SIGMA, BorderEffectType::COPY, HarrisMode::FUSED).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
+	return {
+		{ resultFolder + "/moravec.jpg", image.toQImageWithPoints(image.nonMaxSuppression(moravecPoints, POINTS_LIMIT, NONMAX_FILTER_VALUE)) },
+		{ resultFolder + "/harris.jpg", image.toQImageWithPoints(image.nonMaxSuppression(harrisPoints, POINTS_LIMIT, NONMAX_FILTER_VALUE)) }
+	};
+}
+
+std::vector<TaskOutput> Tasks::descriptors(const QString &source,
+	const QString &sourceModified,
+	const QString &resultPath,
+	DescriptorTaskBase &descriptorTask,
+	const double &minDistanceTreshold)
+{
+	const auto sourceImage = decode(source);
+	const auto sourceImageModified = decode(sourceModified);
+	if (sourceImage.isNull() || sourceImageModified.isNull()) {
+		return {};
+	}
+	const auto image = Image::fromQImage(sourceImage);
+	const auto imageModified = Image::fromQImage(sourceImageModified);
+	const auto harrisPoints = image.harris(HARRIS_SIGMA, BorderEffectType::COPY, HarrisMode::FUSED).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
+	const auto interestingPoints = image.nonMaxSuppression(harrisPoints, POINTS_LIMIT, NONMAX_FILTER_VALUE);
+	const auto harrisPointsOfModified = imageModified.harris(HARRIS_SIGMA, BorderEffectType::COPY, HarrisMode::FUSED).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
+	const auto interestingPointsOfModified = imageModified.nonMaxSuppression(harrisPointsOfModified, POINTS_LIMIT, NONMAX_FILTER_VALUE);
+	const auto descriptors = descriptorTask.getDescriptors(GradientField(image), interestingPoints);
+	const auto descriptorsOfModified = descriptorTask.getDescriptors(GradientField(imageModified), interestingPointsOfModified);
+	auto imageResult = image.toQImageWithPoints(interestingPoints);
+	auto imageModifiedResult = imageModified.toQImageWithPoints(interestingPointsOfModified);
+	QImage finalResult(image.getWidth() + imageModified.getWidth(), std::max(image.getHeight(), imageModified.getHeight()), QImage::Format_RGB32);
+	{
+		QPainter painter(&finalResult);
+		painter.fillRect(finalResult.rect(), QBrush(Qt::white));
+		painter.drawImage(0, 0, imageResult);
+		painter.drawImage(image.getWidth(), 0, imageModifiedResult);
+		DescriptorHelper::drawDescriptors(painter, descriptors, descriptorsOfModified, image.getWidth(), minDistanceTreshold);
+	}
+	return { { resultPath, finalResult } };
+}
+
+std::vector<TaskOutput> Tasks::run(const TaskType type, const QString &source, const QString &sourceModified, const QString &resultPath)
+{
+	switch (type) {
+	case TaskType::SOBEL:
+		return sobel(source, resultPath);
+	case TaskType::PYRAMID:
+		return scalePyramid(source, resultPath);
+	case TaskType::INTERESTING_POINTS:
+		return interestingPoints(source, resultPath);
+	case TaskType::DESCRIPTORS_BASIC: {
+		auto descriptorTask = DescriptorTaskBasic();
+		return descriptors(source, sourceModified, resultPath, descriptorTask);
+	}
+	case TaskType::DESCRIPTORS_ROTATE_INVARIANT: {
+		auto descriptorTask = DescriptorTaskRotateInvariant();
+		return descriptors(source, sourceModified, resultPath, descriptorTask, MINDISTANCE_TRESHOLD);
+	}
+	}
+	Q_ASSERT(false);
+	return {};
+}
+
+bool Tasks::parseType(const QString &name, TaskType &type)
+{
+	if (name == "sobel") {
+		type = TaskType::SOBEL;
+	} else if (name == "pyramid") {
+		type = TaskType::PYRAMID;
+	} else if (name == "interesting") {
+		type = TaskType::INTERESTING_POINTS;
+	} else if (name == "descriptors") {
+		type = TaskType::DESCRIPTORS_BASIC;
+	} else if (name == "descriptors-rotate") {
+		type = TaskType::DESCRIPTORS_ROTATE_INVARIANT;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+bool Tasks::isPairTask(const TaskType type)
+{
+	return type == TaskType::DESCRIPTORS_BASIC || type == TaskType::DESCRIPTORS_ROTATE_INVARIANT;
+}
+
+bool Tasks::hasResultFolder(const TaskType type)
+{
+	return type == TaskType::PYRAMID || type == TaskType::INTERESTING_POINTS;
+}
+
+bool Tasks::save(const std::vector<TaskOutput> &outputs)
+{
+	TRACE_SCOPE("Tasks::save");
+	auto saved = !outputs.empty();
+	for (const auto &output : outputs) {
+		saved = output.image.save(output.path) && saved;
+	}
+	return saved;
+}
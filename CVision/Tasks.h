@@ -0,0 +1,41 @@
+#ifndef COMPUTERVISION_TASKS_H
+#define COMPUTERVISION_TASKS_H
+
+#include <vector>
+#include <limits>
+#include <QImage>
+#include <QString>
+#include "DescriptorTask.h"
+
+struct TaskOutput
+{
+	QString path;
+	QImage image;
+};
+
+enum class TaskType { SOBEL, PYRAMID, INTERESTING_POINTS, DESCRIPTORS_BASIC, DESCRIPTORS_ROTATE_INVARIANT };
+
+// The lab tasks return the images they produce instead of saving them, so a
+// batch can encode and write on a thread of its own.
+// A source that cannot be decoded gives an empty result.
+class Tasks
+{
+public:
+	static std::vector<TaskOutput> sobel(const QString &source, const QString &resultPath);
+	static std::vector<TaskOutput> scalePyramid(const QString &source, const QString &resultFolder);
+	static std::vector<TaskOutput> interestingPoints(const QString &source, const QString &resultFolder);
+	static std::vector<TaskOutput> descriptors(const QString &source,
+		const QString &sourceModified,
+		const QString &resultPath,
+		DescriptorTaskBase &descriptorTask,
+		const double &minDistanceTreshold = std::numeric_limits<double>::max());
+
+	// resultPath is a file for SOBEL and the descriptor tasks and a folder otherwise.
+	static std::vector<TaskOutput> run(const TaskType type, const QString &source, const QString &sourceModified, const QString &resultPath);
+	static bool parseType(const QString &name, TaskType &type);
+	static bool isPairTask(const TaskType type);
+	static bool hasResultFolder(const TaskType type);
+	static bool save(const std::vector<TaskOutput> &outputs);
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "ThreadPool.h"
+#include <atomic>
+#include <qglobal.h>
+
+namespace {
+
+struct ParallelRun {
+	std::atomic<int> next{ 0 };
+	std::atomic<int> finished{ 0 };
+	int tasksCount = 0;
+	const std::function<void(int)> *task = nullptr;
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	void execute() {
+		for (auto index = next++; index < tasksCount; index = next++) {
+			(*task)(index);
+			if (++finished == tasksCount) {
+				std::lock_guard<std::mutex> lock(mutex);
+				condition.notify_all();
+			}
+		}
+	}
+};
+
+thread_local const ThreadPool *currentPool = nullptr;
+thread_local int currentWorker = -1;
+}
+
+ThreadPool::ThreadPool(const int threadsCount)
+{
+	start(threadsCount);
+}
+
+ThreadPool::~ThreadPool()
+{
+	stop();
+}
+
+void ThreadPool::start(const int threadsCount)
+{
+	const auto count = threadsCount > 0 ? threadsCount : getDefaultThreadsCount();
+	for (auto i = 0; i < count - 1; ++i) {
+		_queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (auto i = 0; i < count - 1; ++i) {
+		_workers.emplace_back([this, i] { work(i); });
+	}
+}
+
+// Workers leave only once no task is pending, so everything queued runs before the join.
+void ThreadPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_condition.notify_all();
+	for (auto &worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+	_queues.clear();
+	_stopping = false;
+}
+
+ThreadPool &ThreadPool::instance()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::setThreadsCount(const int threadsCount)
+{
+	instance().resize(threadsCount);
+}
+
+void ThreadPool::resize(const int threadsCount)
+{
+	Q_ASSERT(currentPool != this);
+	stop();
+	start(threadsCount);
+}
+
+int ThreadPool::getDefaultThreadsCount()
+{
+	return std::max(1, int(std::thread::hardware_concurrency()));
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	if (currentPool == this) {
+		auto &queue = *_queues[currentWorker];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	else {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		++_pendingCount;
+	}
+	_condition.notify_one();
+}
+
+bool ThreadPool::takeTask(const int index, std::function<void()> &task)
+{
+	{
+		auto &own = *_queues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_tasks.empty()) {
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+			return true;
+		}
+	}
+	const auto queuesCount = int(_queues.size());
+	for (auto k = 1; k < queuesCount; ++k) {
+		auto &victim = *_queues[(index + k) % queuesCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::work(const int index)
+{
+	currentPool = this;
+	currentWorker = index;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this] { return _stopping || _pendingCount > 0; });
+			if (_pendingCount == 0) {
+				return;
+			}
+			--_pendingCount;
+		}
+		// A pending task exists somewhere; it may be taken by a thief first, so
+		// keep looking until this worker gets one.
+		std::function<void()> task;
+		while (!takeTask(index, task)) {
+			std::this_thread::yield();
+		}
+		task();
+	}
+}
+
+void ThreadPool::run(const int tasksCount, const std::function<void(int)> &task)
+{
+	auto state = std::make_shared<ParallelRun>();
+	state->tasksCount = tasksCount;
+	state->task = &task;
+	const auto helpersCount = std::min(int(_workers.size()), tasksCount - 1);
+	for (auto i = 0; i < helpersCount; ++i) {
+		submit([state] { state->execute(); });
+	}
+	state->execute();
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->condition.wait(lock, [&] { return state->finished == tasksCount; });
+}
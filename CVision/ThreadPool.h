@@ -0,0 +1,77 @@
+#ifndef COMPUTERVISION_THREADPOOL_H
+#define COMPUTERVISION_THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+
+// Work-stealing pool: every worker owns a deque, pushes the tasks it submits to
+// the back and pops them from there, and idle workers steal from the front of
+// the others. Tasks submitted from outside the pool go to a shared queue.
+// Nested parallelFor calls from inside tasks therefore stay on the same threads.
+class ThreadPool {
+	static const int BANDS_PER_THREAD = 4;
+
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::thread> _workers;
+	std::vector<std::unique_ptr<WorkerQueue>> _queues;
+	std::deque<std::function<void()>> _tasks;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	int _pendingCount = 0;
+	bool _stopping = false;
+
+	void start(const int threadsCount);
+	void stop();
+	void work(const int index);
+	bool takeTask(const int index, std::function<void()> &task);
+	void run(const int tasksCount, const std::function<void(int)> &task);
+
+public:
+	explicit ThreadPool(const int threadsCount = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	static ThreadPool &instance();
+	// Resizes the shared pool in place, so references returned by instance() stay valid.
+	// Queued tasks finish first; the pool must not be used from other threads meanwhile.
+	static void setThreadsCount(const int threadsCount);
+	static int getDefaultThreadsCount();
+
+	int getThreadsCount() const { return int(_workers.size()) + 1; }
+	void resize(const int threadsCount);
+	void submit(std::function<void()> task);
+
+	template<typename Func>
+	void parallelFor(const int begin, const int end, Func body);
+};
+
+template<typename Func>
+void ThreadPool::parallelFor(const int begin, const int end, Func body)
+{
+	const auto count = end - begin;
+	if (count <= 0) {
+		return;
+	}
+	const auto bandsCount = std::min(count, getThreadsCount() * BANDS_PER_THREAD);
+	if (bandsCount == 1 || getThreadsCount() == 1) {
+		body(begin, end);
+		return;
+	}
+	run(bandsCount, [&](const int band) {
+		body(begin + int(int64_t(count) * band / bandsCount), begin + int(int64_t(count) * (band + 1) / bandsCount));
+	});
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include "TiledProcessor.h"
+#include "GradientField.h"
+#include "DescriptorHelper.h"
+#include <algorithm>
+#include <QImageReader>
+
+Image ImageTileSource::read(const int top, const int left, const int height, const int width) const
+{
+	Q_ASSERT(top >= 0 && left >= 0 && top + height <= getHeight() && left + width <= getWidth());
+	auto result = Image::createUninitialized(height, width);
+	for (auto i = 0; i < height; ++i) {
+		const auto source = _image.getRow(top + i) + left;
+		std::copy(source, source + width, result.getData() + size_t(i) * width);
+	}
+	return result;
+}
+
+ImageFileTileSource::ImageFileTileSource(const QString &fileName, const GrayScaleMod grayScaleMod)
+	: _fileName(fileName), _grayScaleMod(grayScaleMod)
+{
+	const auto size = QImageReader(fileName).size();
+	_height = size.height();
+	_width = size.width();
+}
+
+Image ImageFileTileSource::read(const int top, const int left, const int height, const int width) const
+{
+	QImageReader reader(_fileName);
+	reader.setClipRect(QRect(left, top, width, height));
+	return Image::fromQImage(reader.read(), _grayScaleMod);
+}
+
+TiledProcessor::TiledProcessor(const TileSource &source, const int tileSize, const BorderEffectType borderEffect)
+	: _source(source), _tileSize(tileSize), _borderEffect(borderEffect)
+{
+	Q_ASSERT(tileSize > 0);
+	Q_ASSERT(borderEffect != BorderEffectType::CYCLICAL);
+}
+
+void TiledProcessor::getWindow(const int coreBegin, const int coreEnd, const int size, const int halo, const int minExtent, int &begin, int &end)
+{
+	begin = std::max(0, coreBegin - halo);
+	end = std::min(size, coreEnd + halo);
+	const auto extent = std::min(size, minExtent);
+	if (end - begin < extent) {
+		end = std::min(size, begin + extent);
+		begin = end - extent;
+	}
+}
+
+std::vector<Tile> TiledProcessor::getTiles(const int halo, const int minExtent) const
+{
+	auto result = std::vector<Tile>();
+	for (auto coreTop = 0; coreTop < _source.getHeight(); coreTop += _tileSize) {
+		for (auto coreLeft = 0; coreLeft < _source.getWidth(); coreLeft += _tileSize) {
+			auto tile = Tile();
+			tile.coreTop = coreTop;
+			tile.coreLeft = coreLeft;
+			tile.coreHeight = std::min(_tileSize, _source.getHeight() - coreTop);
+			tile.coreWidth = std::min(_tileSize, _source.getWidth() - coreLeft);
+			auto bottom = 0, right = 0;
+			getWindow(coreTop, coreTop + tile.coreHeight, _source.getHeight(), halo, minExtent, tile.top, bottom);
+			getWindow(coreLeft, coreLeft + tile.coreWidth, _source.getWidth(), halo, minExtent, tile.left, right);
+			tile.height = bottom - tile.top;
+			tile.width = right - tile.left;
+			result.push_back(tile);
+		}
+	}
+	return result;
+}
+
+Image TiledProcessor::readWindow(const Tile &tile) const
+{
+	return _source.read(tile.top, tile.left, tile.height, tile.width);
+}
+
+std::vector<ImagePoint> TiledProcessor::getHarrisLocalMaximums(const double sigma, const int shift, const double treshold) const
+{
+	// Sobel, then the Gaussian over the tensor, then the maximum window: each
+	// stage spoils at most its own radius next to an artificial tile edge.
+	// Windows of at least twice the radius keep the Gaussian from being clamped
+	// to a different size than on the whole frame.
+	const auto radius = Image::getGaussRadius(sigma, _source.getHeight(), _source.getWidth());
+	auto result = std::vector<ImagePoint>();
+	for (const auto &tile : getTiles(1 + radius + shift, 2 * radius)) {
+		const auto window = readWindow(tile);
+		for (const auto &point : window.harris(sigma, _borderEffect, HarrisMode::FUSED).getLocalMaximums(shift, treshold, _borderEffect)) {
+			const auto i = point.getX() + tile.top;
+			const auto j = point.getY() + tile.left;
+			if (tile.owns(i, j)) {
+				result.emplace_back(i, j, point.getValue());
+			}
+		}
+	}
+	std::sort(result.begin(), result.end(), [](const ImagePoint &a, const ImagePoint &b) {
+		return a.getX() < b.getX() || (a.getX() == b.getX() && a.getY() < b.getY());
+	});
+	return result;
+}
+
+template<typename Build>
+DescriptorSet TiledProcessor::getDescriptors(const std::vector<ImagePoint> &points, const int windowRadius, Build build) const
+{
+	auto pointDescriptors = std::vector<DescriptorSet>(points.size());
+	for (const auto &tile : getTiles(windowRadius + 1)) {
+		auto indices = std::vector<int>();
+		for (auto k = 0; k < int(points.size()); ++k) {
+			if (tile.owns(points[k].getX(), points[k].getY())) {
+				indices.push_back(k);
+			}
+		}
+		if (indices.empty()) {
+			continue;
+		}
+		const auto gradient = GradientField(readWindow(tile), _borderEffect, windowRadius);
+		for (auto k : indices) {
+			const auto local = std::vector<ImagePoint>{ ImagePoint(points[k].getX() - tile.top, points[k].getY() - tile.left, points[k].getValue()) };
+			pointDescriptors[k] = build(gradient, local);
+		}
+	}
+	auto result = DescriptorSet();
+	result.reserve(int(points.size()));
+	for (auto k = 0; k < int(points.size()); ++k) {
+		for (auto row = 0; row < pointDescriptors[k].getCount(); ++row) {
+			result.addCopy(pointDescriptors[k], row, points[k].getX(), points[k].getY());
+		}
+	}
+	return result;
+}
+
+DescriptorSet TiledProcessor::getDescriptors(const std::vector<ImagePoint> &points, const int gaussKernelRadius) const
+{
+	return getDescriptors(points, gaussKernelRadius, [&](const GradientField &gradient, const std::vector<ImagePoint> &local) {
+		return DescriptorHelper::getDescriptors(gradient, local, gaussKernelRadius);
+	});
+}
+
+DescriptorSet TiledProcessor::getDescriptorsRotateInvariant(const std::vector<ImagePoint> &points, const int gaussKernelRadius) const
+{
+	return getDescriptors(points, 2 * gaussKernelRadius, [&](const GradientField &gradient, const std::vector<ImagePoint> &local) {
+		return DescriptorHelper::getDescriptorsRotateInvariant(gradient, local, gaussKernelRadius);
+	});
+}
@@ -0,0 +1,92 @@
+#ifndef COMPUTERVISION_TILEDPROCESSOR_H
+#define COMPUTERVISION_TILEDPROCESSOR_H
+
+#include <vector>
+#include <QString>
+#include "Image.h"
+#include "ImageView.h"
+#include "ImagePoint.h"
+#include "DescriptorSet.h"
+#include "ConstantValues.h"
+
+class GradientField;
+
+// Rectangular windows of a frame that is never held in memory as a whole.
+class TileSource
+{
+public:
+	virtual ~TileSource() {}
+	virtual int getHeight() const = 0;
+	virtual int getWidth() const = 0;
+	virtual Image read(const int top, const int left, const int height, const int width) const = 0;
+};
+
+class ImageTileSource : public TileSource
+{
+	ImageView _image;
+
+public:
+	explicit ImageTileSource(const ImageView &image) : _image(image) {}
+
+	virtual int getHeight() const { return _image.getHeight(); }
+	virtual int getWidth() const { return _image.getWidth(); }
+	virtual Image read(const int top, const int left, const int height, const int width) const;
+};
+
+// Decodes one window per read through QImageReader's clip rect, so readers that
+// support partial decoding never materialize the whole frame.
+class ImageFileTileSource : public TileSource
+{
+	QString _fileName;
+	GrayScaleMod _grayScaleMod;
+	int _height = 0,
+		_width = 0;
+
+public:
+	explicit ImageFileTileSource(const QString &fileName, const GrayScaleMod grayScaleMod = GrayScaleMod::SRGB_HDTV);
+
+	virtual int getHeight() const { return _height; }
+	virtual int getWidth() const { return _width; }
+	virtual Image read(const int top, const int left, const int height, const int width) const;
+};
+
+// The core is the part of the frame a tile owns; the window around it adds the
+// halo that the operator chain needs to compute the core exactly.
+struct Tile
+{
+	int top, left, height, width;
+	int coreTop, coreLeft, coreHeight, coreWidth;
+
+	bool owns(const int i, const int j) const {
+		return i >= coreTop && i < coreTop + coreHeight && j >= coreLeft && j < coreLeft + coreWidth;
+	}
+};
+
+// Runs the Harris, local maximum and descriptor chains one tile at a time, so
+// memory is bounded by the tile size instead of the frame size. Every tile keeps
+// only the results inside its core, which makes seams duplicate-free, and the
+// windows are wide enough that results equal whole-image processing.
+// CYCLICAL borders need the opposite edge of the frame and are not supported.
+class TiledProcessor
+{
+	const TileSource &_source;
+	int _tileSize;
+	BorderEffectType _borderEffect;
+
+	static void getWindow(const int coreBegin, const int coreEnd, const int size, const int halo, const int minExtent, int &begin, int &end);
+
+	template<typename Build>
+	DescriptorSet getDescriptors(const std::vector<ImagePoint> &points, const int windowRadius, Build build) const;
+
+public:
+	TiledProcessor(const TileSource &source, const int tileSize = TILE_SIZE, const BorderEffectType borderEffect = BorderEffectType::COPY);
+
+	std::vector<Tile> getTiles(const int halo, const int minExtent = 0) const;
+	Image readWindow(const Tile &tile) const;
+
+	std::vector<ImagePoint> getHarrisLocalMaximums(const double sigma, const int shift, const double treshold) const;
+	DescriptorSet getDescriptors(const std::vector<ImagePoint> &points, const int gaussKernelRadius) const;
+	DescriptorSet getDescriptorsRotateInvariant(const std::vector<ImagePoint> &points, const int gaussKernelRadius) const;
+};
+
+#endif
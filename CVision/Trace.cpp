@@ -0,0 +1,155 @@
+#include "Trace.h"
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdio>
+#include <algorithm>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+namespace {
+	struct ThreadBuffer
+	{
+		std::mutex mutex;
+		std::vector<TraceEvent> events;
+	};
+
+	// Buffers outlive their threads, so a trace can be saved after a pool is gone.
+	struct TraceRegistry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+		std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+	};
+
+	TraceRegistry &getRegistry()
+	{
+		static auto registry = new TraceRegistry();
+		return *registry;
+	}
+
+	thread_local ThreadBuffer *currentBuffer = nullptr;
+	thread_local auto currentThread = 0;
+
+	std::vector<TraceEvent> collectEvents()
+	{
+		auto &registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		auto result = std::vector<TraceEvent>();
+		for (auto &buffer : registry.buffers) {
+			std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+			result.insert(result.end(), buffer->events.begin(), buffer->events.end());
+		}
+		return result;
+	}
+}
+
+int64_t Tracer::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - getRegistry().origin).count();
+}
+
+void Tracer::record(const TraceEvent &event)
+{
+	if (currentBuffer == nullptr) {
+		auto &registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+		currentBuffer = registry.buffers.back().get();
+		currentThread = int(registry.buffers.size());
+	}
+	std::lock_guard<std::mutex> lock(currentBuffer->mutex);
+	currentBuffer->events.push_back(event);
+	currentBuffer->events.back().thread = currentThread;
+}
+
+void Tracer::clear()
+{
+	auto &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (auto &buffer : registry.buffers) {
+		std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+		buffer->events.clear();
+	}
+}
+
+bool Tracer::saveChromeTrace(const QString &fileName)
+{
+	QJsonArray traceEvents;
+	for (const auto &event : collectEvents()) {
+		QJsonObject arguments;
+		if (event.height >= 0) {
+			arguments.insert("height", event.height);
+			arguments.insert("width", event.width);
+		}
+		if (event.points >= 0) {
+			arguments.insert("points", event.points);
+		}
+		if (event.octave >= 0) {
+			arguments.insert("octave", event.octave);
+			arguments.insert("scale", event.scale);
+		}
+		QJsonObject traceEvent;
+		traceEvent.insert("name", event.name);
+		traceEvent.insert("ph", "X");
+		traceEvent.insert("pid", 1);
+		traceEvent.insert("tid", event.thread);
+		traceEvent.insert("ts", event.start / 1000.);
+		traceEvent.insert("dur", event.duration / 1000.);
+		traceEvent.insert("args", arguments);
+		traceEvents.append(traceEvent);
+	}
+	QJsonObject trace;
+	trace.insert("traceEvents", traceEvents);
+	trace.insert("displayTimeUnit", "ms");
+	const auto json = QJsonDocument(trace).toJson(QJsonDocument::Compact);
+	QFile file(fileName);
+	return file.open(QIODevice::WriteOnly) && file.write(json) == json.size();
+}
+
+QString Tracer::getSummary()
+{
+	struct Stage
+	{
+		const char *name;
+		int calls;
+		int64_t total;
+		int64_t minimum;
+		int64_t maximum;
+	};
+
+	auto stages = std::map<std::string, Stage>();
+	for (const auto &event : collectEvents()) {
+		auto found = stages.find(event.name);
+		if (found == stages.end()) {
+			stages.emplace(event.name, Stage{ event.name, 1, event.duration, event.duration, event.duration });
+			continue;
+		}
+		auto &stage = found->second;
+		++stage.calls;
+		stage.total += event.duration;
+		stage.minimum = std::min(stage.minimum, event.duration);
+		stage.maximum = std::max(stage.maximum, event.duration);
+	}
+	auto sorted = std::vector<Stage>();
+	for (const auto &stage : stages) {
+		sorted.push_back(stage.second);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const Stage &a, const Stage &b) {
+		return a.total > b.total;
+	});
+	char line[256];
+	snprintf(line, sizeof(line), "%-48s %8s %12s %10s %10s %10s\n", "stage", "calls", "total ms", "mean ms", "min ms", "max ms");
+	auto result = std::string(line);
+	for (const auto &stage : sorted) {
+		snprintf(line, sizeof(line), "%-48s %8d %12.3f %10.3f %10.3f %10.3f\n",
+			stage.name, stage.calls, stage.total / 1e6, stage.total / 1e6 / stage.calls, stage.minimum / 1e6, stage.maximum / 1e6);
+		result += line;
+	}
+	return QString::fromStdString(result);
+}
@@ -0,0 +1,71 @@
+#ifndef COMPUTERVISION_TRACE_H
+#define COMPUTERVISION_TRACE_H
+
+#include <cstdint>
+#include <QString>
+
+struct TraceEvent
+{
+	const char *name;
+	int64_t start;
+	int64_t duration;
+	int thread;
+	int height;
+	int width;
+	int points;
+	int octave;
+	int scale;
+};
+
+// Stage timings for production runs. Every thread appends to a buffer of its
+// own, so recording a scope costs two clock reads and an uncontended lock.
+// Stage names must be string literals. Export while no stage is running.
+class Tracer
+{
+	Tracer() = delete;
+
+public:
+	static int64_t now();
+	static void record(const TraceEvent &event);
+	static void clear();
+
+	// Chrome trace event format, opens in chrome://tracing and Perfetto.
+	static bool saveChromeTrace(const QString &fileName);
+	// Calls, total, mean, min and max time per stage, slowest stage first.
+	// Times are inclusive: harris also counts the sobel it runs.
+	static QString getSummary();
+};
+
+class TraceScope
+{
+	TraceEvent _event;
+
+public:
+	explicit TraceScope(const char *name, const int height = -1, const int width = -1)
+		: _event{ name, Tracer::now(), 0, 0, height, width, -1, -1, -1 } {}
+	~TraceScope() {
+		_event.duration = Tracer::now() - _event.start;
+		Tracer::record(_event);
+	}
+	TraceScope(const TraceScope &) = delete;
+	TraceScope &operator=(const TraceScope &) = delete;
+
+	void setPointsCount(const int points) { _event.points = points; }
+	void setLevel(const int octave, const int scale) { _event.octave = octave; _event.scale = scale; }
+};
+
+// Define CVISION_TRACE to record; otherwise the macros expand to nothing.
+// One TRACE_SCOPE per block; the setters refer to the scope of their block.
+#ifdef CVISION_TRACE
+#define TRACE_SCOPE(name) TraceScope traceScope(name)
+#define TRACE_SCOPE_IMAGE(name, height, width) TraceScope traceScope(name, height, width)
+#define TRACE_SET_POINTS(count) traceScope.setPointsCount(int(count))
+#define TRACE_SET_LEVEL(octave, scale) traceScope.setLevel(octave, scale)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_IMAGE(name, height, width)
+#define TRACE_SET_POINTS(count)
+#define TRACE_SET_LEVEL(octave, scale)
+#endif
+
+#endif
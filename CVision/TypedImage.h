@@ -0,0 +1,76 @@
+#ifndef COMPUTERVISION_TYPEDIMAGE_H
+#define COMPUTERVISION_TYPEDIMAGE_H
+
+#include <memory>
+#include <cstdint>
+#include <qglobal.h>
+#include "Image.h"
+
+template<typename T>
+class TypedImage {
+	int _height = 0,
+		_width = 0;
+
+	std::unique_ptr<T[]> _data = nullptr;
+
+public:
+	typedef T PixelType;
+
+	TypedImage() {}
+
+	TypedImage(const int height, const int width) : _height(height),
+		_width(width),
+		_data(std::make_unique<T[]>(size_t(height) * width))
+	{
+	}
+
+	TypedImage(const TypedImage &image) : TypedImage(image._height, image._width)
+	{
+		std::copy(image.getData(), image.getData() + size_t(_height) * _width, getData());
+	}
+
+	TypedImage(TypedImage &&image) = default;
+
+	TypedImage &operator=(const TypedImage &image)
+	{
+		if (this != &image) {
+			*this = TypedImage(image);
+		}
+		return *this;
+	}
+
+	TypedImage &operator=(TypedImage &&image) = default;
+
+	int getHeight() const { return _height; }
+	int getWidth() const { return _width; }
+	const T *getData() const { return _data.get(); }
+	T *getData() { return _data.get(); }
+	const T *getRow(const int i) const { return _data.get() + size_t(i) * _width; }
+	T *getRow(const int i) { return _data.get() + size_t(i) * _width; }
+
+	bool contains(const int i, const int j) const {
+		return i >= 0 && i < getHeight() && j >= 0 && j < getWidth();
+	}
+
+	T get(const int i, const int j) const {
+		Q_ASSERT(contains(i, j));
+		return _data[size_t(i) * _width + j];
+	}
+
+	void set(const int i, const int j, const T value) {
+		Q_ASSERT(contains(i, j));
+		_data[size_t(i) * _width + j] = value;
+	}
+
+	T getValue(const int i, const int j, const BorderEffectType borderEffect = BorderEffectType::COPY) const {
+		const auto row = Image::getBorderIndex(i, getHeight(), borderEffect);
+		const auto column = Image::getBorderIndex(j, getWidth(), borderEffect);
+		return row < 0 || column < 0 ? T(0) : get(row, column);
+	}
+};
+
+typedef TypedImage<uint8_t> ByteImage;
+typedef TypedImage<int16_t> ShortImage;
+typedef TypedImage<int32_t> IntImage;
+
+#endif
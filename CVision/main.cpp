@@ -1,68 +1,58 @@
-#include "Image.h"
-#include "ScalePyramid.h"
-#include <QPainter>
-#include "DescriptorTask.h"
+#include <cstdio>
+#include <cstdlib>
+#include <QFileInfo>
+#include "Tasks.h"
+#include "BatchProcessor.h"
+#include "ThreadPool.h"
 #include "ConstantValues.h"
-#include "DescriptorHelper.h"
+#include "Trace.h"
 
-void sobel(const QString &source, const QString &resultPath) {
-	Image::fromQImage(QImage(source))
-		.sobel()
-		.getNormalized()
-		.saveAsImage(resultPath);
-}
-
-void scalePyramid(const QString &source, const QString &resultFolder) {
-	Image::fromQImage(QImage(source))
-		.buildScalePyramid(SCALES_PER_OCTAVE, BASE_SIGMA, SIGMA)
-		.saveAsImageSet(resultFolder);
-}
-
-void interestingPoints(const QString &source, const QString &resultFolder)
-{
-	const auto image = Image::fromQImage(QImage(source));
-	const auto moravecPoints = image.moravec(MORAVEC_SHIFT).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
-	image.toQImageWithPoints(image.nonMaxSuppression(moravecPoints, POINTS_LIMIT, NONMAX_FILTER_VALUE)).save(resultFolder + "/moravec.jpg");
-	const auto harrisPoints = image.harris(HARRIS_SIGMA).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
-	image.toQImageWithPoints(image.nonMaxSuppression(harrisPoints, POINTS_LIMIT, NONMAX_FILTER_VALUE)).save(resultFolder + "/harris.jpg");
-}
+namespace {
+	void reportTrace()
+	{
+#ifdef CVISION_TRACE
+		Tracer::saveChromeTrace(TRACE_FILE);
+		fputs(Tracer::getSummary().toLocal8Bit().constData(), stderr);
+#endif
+	}
 
-void descriptors(const QString &source, 
-	const QString &sourceModified, 
-	const QString &resultPath, 
-	DescriptorTaskBase &descriptorTask, 
-	const double &minDistanceTreshold = std::numeric_limits<double>::max())
-{
-	const auto image = Image::fromQImage(QImage(source));
-	const auto imageModified = Image::fromQImage(QImage(sourceModified));
-	const auto harrisPoints = image.harris(HARRIS_SIGMA).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
-	const auto interestingPoints = image.nonMaxSuppression(harrisPoints, POINTS_LIMIT, NONMAX_FILTER_VALUE);
-	const auto harrisPointsOfModified = imageModified.harris(HARRIS_SIGMA).getLocalMaximums(LOCAL_MAXIMUMS_SHIFT, LOCAL_MAXIMUMS_TRESHOLD);
-	const auto interestingPointsOfModified = imageModified.nonMaxSuppression(harrisPointsOfModified, POINTS_LIMIT, NONMAX_FILTER_VALUE);
-	const auto descriptors = descriptorTask.getDescriptors(image, interestingPoints);
-	const auto descriptorsOfModified = descriptorTask.getDescriptors(imageModified, interestingPointsOfModified);
-	auto imageResult = image.toQImageWithPoints(interestingPoints);
-	auto imageModifiedResult = imageModified.toQImageWithPoints(interestingPointsOfModified);
-	QImage finalResult(image.getWidth() + imageModified.getWidth(), std::max(image.getHeight(), imageModified.getHeight()), QImage::Format_RGB32);
-	QPainter painter(&finalResult);
-	painter.fillRect(finalResult.rect(), QBrush(Qt::white));
-	painter.drawImage(0, 0, imageResult);
-	painter.drawImage(image.getWidth(), 0, imageModifiedResult);
-	DescriptorHelper::drawDescriptors(painter, descriptors, descriptorsOfModified, image.getWidth(), minDistanceTreshold);
-	finalResult.save(resultPath);
+	int runBatch(const int argc, char *argv[])
+	{
+		auto type = TaskType::SOBEL;
+		if (argc < 4 || !Tasks::parseType(argv[1], type)) {
+			fprintf(stderr, "usage: %s sobel|pyramid|interesting|descriptors|descriptors-rotate <manifest|folder> <result folder> [threads]\n", argv[0]);
+			return 1;
+		}
+		if (argc > 4) {
+			ThreadPool::setThreadsCount(atoi(argv[4]));
+		}
+		const auto input = QString(argv[2]);
+		const auto items = QFileInfo(input).isDir() ? BatchProcessor::listFolder(input, type) : BatchProcessor::readManifest(input);
+		const auto failed = BatchProcessor::run(type, items, argv[3], [](const BatchProgress &progress) {
+			fprintf(stderr, "[%d/%d] %s%s\n", progress.done, progress.total,
+				progress.source.toLocal8Bit().constData(), progress.succeeded ? "" : " FAILED");
+		});
+		fprintf(stderr, "%d of %d images failed\n", failed, int(items.size()));
+		reportTrace();
+		return failed == 0 ? 0 : 2;
+	}
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+	if (argc > 1) {
+		return runBatch(argc, argv);
+	}
 	//#1
-	sobel(SOURCE, RESULT_SOBEL);
+	Tasks::save(Tasks::run(TaskType::SOBEL, SOURCE, QString(), RESULT_SOBEL));
 	//#2
-	scalePyramid(SOURCE, RESULT_PYRAMID_FOLDER);
+	Tasks::save(Tasks::run(TaskType::PYRAMID, SOURCE, QString(), RESULT_PYRAMID_FOLDER));
 	//#3
-	interestingPoints(SOURCE, RESULT_INTERESTING_FOLDER);
+	Tasks::save(Tasks::run(TaskType::INTERESTING_POINTS, SOURCE, QString(), RESULT_INTERESTING_FOLDER));
 	//#4
-	descriptors(SOURCE, SOURCE_MODIFIED_BASIC, RESULT_DESCRIPTORS_BASIC, DescriptorTaskBasic());
+	Tasks::save(Tasks::run(TaskType::DESCRIPTORS_BASIC, SOURCE, SOURCE_MODIFIED_BASIC, RESULT_DESCRIPTORS_BASIC));
 	//#5
-	descriptors(SOURCE, SOURCE_MODIFIED_ROTATION, RESULT_DESCRIPTORS_ROTATE_INVARIANT, DescriptorTaskRotateInvariant(), MINDISTANCE_TRESHOLD);
+	Tasks::save(Tasks::run(TaskType::DESCRIPTORS_ROTATE_INVARIANT, SOURCE, SOURCE_MODIFIED_ROTATION, RESULT_DESCRIPTORS_ROTATE_INVARIANT));
+	reportTrace();
 	return 0;
-}
\ No newline at end of file
+}